@@ -0,0 +1,615 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file bench.cpp
+@date October 2026
+@brief Microbenchmark suite of the logging and error system.
+
+Each benchmark is printed as one JSON object per line:
+@code
+{"bench":"log_null_sink","variant":"shared","iterations":1048576,"ns_per_op":45.2,"allocs_per_op":3.00}
+@endcode
+so results can be collected and compared over releases.
+The variant is "shared" for bench_NgoErr, linked to the shared library, and "static" for
+bench_NgoErr_static, linked to the static library with link time optimization.
+Allocations are counted by replacing the global operator new of the executable.
+On ELF platforms, this replacement is also used by the shared library; on Windows,
+the DLL uses its own allocator and only allocations of the benchmark itself are counted.
+
+Usage : bench_NgoErr [filter] [--min-time=seconds]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ngoerr/NgoError.h"
+#include "ngoerr/NgoErrorChecks.h"
+#include "ngoerr/NgoErrorCollector.h"
+#include "ngoerr/NgoLastError.h"
+#include "ngoerr/NgoLogging.h"
+#include "ngoerr/NgoLogConfig.h"
+#include "ngoerr/NgoLoggerCompressed.h"
+#include "ngoerr/NgoScopeTimer.h"
+#include "ngoerr/NgoTrace.h"
+
+/*******************************************************************************
+   ALLOCATION COUNTER
+*******************************************************************************/
+static std::atomic<unsigned long long> g_allocations(0);
+
+void * operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1,std::memory_order_relaxed);
+    void * p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void * operator new[](std::size_t size)
+{
+    g_allocations.fetch_add(1,std::memory_order_relaxed);
+    void * p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+/*******************************************************************************
+   BENCHMARK HARNESS
+*******************************************************************************/
+const char * g_filter = 0L;
+double g_minTime = 0.2;
+#ifdef NGO_ERR_USE_DYN
+const char * variant = "shared";
+#else
+const char * variant = "static";
+#endif
+
+NGOLOG_DEFINE_CATEGORY(NgoLogBenchKernel, logWARNING);
+NGOLOG_DEFINE_CATEGORY(NgoLogBenchSolver, logDEBUG4);
+
+/*! @brief logger discarding everything, to measure the cost of the dispatch only */
+class NgoLoggerNull : public NgoLogger
+{
+public:
+    NgoLoggerNull(TLogLevel reportingLevel=logDEBUG4) : NgoLogger(reportingLevel) {}
+    virtual void output(const TLogLevel, std::string &) {}
+    virtual void flush() {}
+};
+
+/*! @brief runs op(i) in batches of growing size until the minimum time is reached, then reports */
+template <class Op>
+void run(const std::string & name, Op op)
+{
+    if (g_filter && name.find(g_filter) == std::string::npos)
+        return;
+    typedef std::chrono::steady_clock clock;
+    unsigned long long iterations = 1;
+    for (;;)
+    {
+        unsigned long long allocs0 = g_allocations.load();
+        clock::time_point t0 = clock::now();
+        for (unsigned long long i=0;i<iterations;i++)
+            op(i);
+        clock::time_point t1 = clock::now();
+        unsigned long long allocs = g_allocations.load() - allocs0;
+        double elapsed = std::chrono::duration<double>(t1-t0).count();
+        if (elapsed >= g_minTime || iterations >= (1ULL<<32))
+        {
+            printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.2f}\n",
+                   name.c_str(), variant, iterations, elapsed*1e9/iterations, double(allocs)/iterations);
+            fflush(stdout);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+/*! @brief runs op(i) on several threads at once, in batches of growing size as run does */
+/*! The time per op is the elapsed time divided by the number of ops of a thread, so that it stays
+flat as long as the threads do not contend. reset is called between the batches, untimed */
+template <class Op, class Reset>
+void runThreads(const std::string & name, unsigned threads, Op op, Reset reset)
+{
+    if (g_filter && name.find(g_filter) == std::string::npos)
+        return;
+    typedef std::chrono::steady_clock clock;
+    unsigned long long iterations = 1;
+    for (;;)
+    {
+        std::atomic<unsigned> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> pool;
+        for (unsigned t=0;t<threads;t++)
+            pool.push_back(std::thread([&ready,&go,&op,iterations]() {
+                ready++;
+                while (!go.load())
+                    std::this_thread::yield();
+                for (unsigned long long i=0;i<iterations;i++)
+                    op(i);
+            }));
+        while (ready.load() < threads)
+            std::this_thread::yield();
+        unsigned long long allocs0 = g_allocations.load();
+        clock::time_point t0 = clock::now();
+        go.store(true);
+        for (unsigned t=0;t<threads;t++)
+            pool[t].join();
+        clock::time_point t1 = clock::now();
+        unsigned long long allocs = g_allocations.load() - allocs0;
+        reset();
+        double elapsed = std::chrono::duration<double>(t1-t0).count();
+        if (elapsed >= g_minTime || iterations >= (1ULL<<32))
+        {
+            printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"threads\":%u,\"iterations\":%llu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.2f}\n",
+                   name.c_str(), variant, threads, iterations, elapsed*1e9/iterations, double(allocs)/(iterations*threads));
+            fflush(stdout);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+/*******************************************************************************
+   LOGGING BENCHMARKS
+*******************************************************************************/
+void benchLogging()
+{
+    // startup and teardown of the library: init registers the default logger, shutdown deletes it
+    run("manager_init_shutdown", [](unsigned long long) {
+        NgoLoggerManager::init();
+        NgoLoggerManager::shutdown();
+    });
+    NgoLoggerManager::kill();
+
+    new NgoLoggerNull(logERROR);
+    run("log_disabled", [](unsigned long long i) {
+        NGOLOG(logDEBUG4) << "disabled log " << i;
+    });
+    NgoLoggerManager::kill();
+
+    new NgoLoggerNull(logDEBUG4);
+    run("log_category_compiled_out", [](unsigned long long i) {
+        NGOLOG_CAT(NgoLogBenchKernel, logDEBUG) << "compiled out log " << i;
+    });
+    NgoLoggerManager::kill();
+
+    // compiled in, disabled by the configuration of the category
+    new NgoLoggerNull(logDEBUG4);
+    NgoLogConfig::configure("NgoLogBenchSolver=ERROR");
+    run("log_category_disabled_at_runtime", [](unsigned long long i) {
+        NGOLOG_CAT(NgoLogBenchSolver, logDEBUG) << "disabled log " << i;
+    });
+    NgoLoggerManager::kill();
+
+    new NgoLoggerNull(logDEBUG4);
+    run("log_null_sink", [](unsigned long long i) {
+        NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+    });
+    NgoLoggerManager::kill();
+
+    new NgoLoggerNull(logDEBUG4);
+    NgoLoggerManager::get()->enableThreadBuffers();
+    run("log_null_sink_thread_buffers", [](unsigned long long i) {
+        NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+    });
+    NgoLoggerManager::kill();
+
+    FILE * tmp = tmpfile();
+    if (tmp)
+    {
+        new NgoLoggerFile(tmp,logDEBUG4);
+        run("log_file", [](unsigned long long i) {
+            NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+        });
+        NgoLoggerManager::kill();
+        fclose(tmp);
+    }
+
+    // the logging thread only appends to the queue of the file logger
+    tmp = tmpfile();
+    if (tmp)
+    {
+        new NgoLoggerFile(tmp,logDEBUG4);
+        NgoLoggerManager::get()->enableSinkWorkers();
+        run("log_file_sink_worker", [](unsigned long long i) {
+            NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+        });
+        NgoLoggerManager::kill();
+        fclose(tmp);
+    }
+
+    // the records are copied into a block, compressed and written by the background thread
+    new NgoLoggerCompressed("bench_NgoErr.ngz",65536,logDEBUG4);
+    run("log_compressed_file", [](unsigned long long i) {
+        NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+    });
+    NgoLoggerManager::kill();
+    remove("bench_NgoErr.ngz");
+
+    NgoLoggerBufferedString * buffered = new NgoLoggerBufferedString(logDEBUG4);
+    run("log_buffered_string", [buffered](unsigned long long i) {
+        NGOLOG(logINFO) << "iteration " << i << " value " << 1.2345;
+        if ((i & 1023) == 1023)
+            buffered->getBufferedMessage();
+    });
+    NgoLoggerManager::kill();
+
+    // DEBUG logs of numbers: values one by one, and an array
+    new NgoLoggerNull(logDEBUG4);
+    static double values[16];
+    for (unsigned i=0;i<16;i++)
+        values[i] = std::exp(0.731*i-5.)*(i%3 ? 1. : -1.);
+    run("log_doubles_8", [](unsigned long long) {
+        NGOLOG(logDEBUG) << "T " << values[0] << " P " << values[1] << " x " << values[2] << " " << values[3]
+                         << " " << values[4] << " y " << values[5] << " " << values[6] << " " << values[7];
+    });
+    run("log_double_array_16_loop", [](unsigned long long) {
+        NgoLog log(logDEBUG);
+        log.get() << "x ";
+        for (unsigned i=0;i<16;i++)
+            log.get() << (i ? " " : "") << values[i];
+    });
+    run("log_double_array_16", [](unsigned long long) {
+        NGOLOG(logDEBUG) << "x " << NgoLogArray(values,16);
+    });
+    NgoLoggerManager::kill();
+
+    // the same warning in a loop: each one dispatched, or counted and reported once
+    tmp = tmpfile();
+    if (tmp)
+    {
+        new NgoLoggerFile(tmp,logDEBUG4);
+        run("log_file_repeated", [](unsigned long long) {
+            NGOLOG(logWARNING) << "pressure clipped to the lower bound";
+        });
+        NgoLoggerManager::get()->enableRepeatCoalescing();
+        run("log_file_repeated_coalesced", [](unsigned long long) {
+            NGOLOG(logWARNING) << "pressure clipped to the lower bound";
+        });
+        run("log_file_distinct_coalescing", [](unsigned long long i) {
+            NGOLOG(logWARNING) << "pressure clipped at iteration " << i;
+        });
+        NgoLoggerManager::kill();
+        fclose(tmp);
+    }
+
+    new NgoLoggerNull(logDEBUG4);
+    run("logf_null_sink", [](unsigned long long i) {
+        NgoLogf(logINFO,"iteration %llu value %g",i,1.2345);
+    });
+    NgoLoggerManager::kill();
+
+    // the lock free check of NGOLOG, neither formatting nor locking
+    new NgoLoggerNull(logERROR);
+    run("logf_disabled", [](unsigned long long i) {
+        NgoLogf(logDEBUG4,"iteration %llu value %g",i,1.2345);
+    });
+    NgoLoggerManager::kill();
+
+    new NgoLoggerNull(logDEBUG4);
+    static NgoLogEntry batch[16];
+    for (unsigned i=0;i<16;i++)
+    {
+        batch[i].level = logINFO;
+        batch[i].text = "a record of a batch submitted by a Fortran host";
+        batch[i].length = -1;
+    }
+    // reported per record
+    run("log_write_batch_16", [](unsigned long long i) {
+        if (i%16 == 0)
+            NgoLogWriteBatch(batch,16);
+    });
+    NgoLoggerManager::kill();
+
+    static const unsigned histories[] = {10, 100, 1000, 10000};
+    for (unsigned h=0;h<sizeof(histories)/sizeof(histories[0]);h++)
+    {
+        new NgoLoggerNull(logDEBUG4);
+        for (unsigned i=0;i<histories[h];i++)
+            NgoLog(logINFO,true).get() << "unique message " << i;
+        char name[64];
+        sprintf(name,"unique_log_history_%u",histories[h]);
+        const unsigned last = histories[h]-1;
+        // the last registered message is the worst case of the history lookup
+        run(name, [last](unsigned long long) {
+            NgoLog(logINFO,true).get() << "unique message " << last;
+        });
+        NgoLoggerManager::kill();
+    }
+
+    // timing a phase: a log of each duration, against a sample recorded into a histogram
+    new NgoLoggerNull(logDEBUG4);
+    run("phase_clock_and_log", [](unsigned long long) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        NGOLOG(logDEBUG) << "phase took " << std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count() << " s";
+    });
+    run("phase_scope_timer", [](unsigned long long) {
+        NGO_SCOPE_TIMER("bench.phase");
+    });
+    NgoLoggerManager::kill();
+
+    // a span only keeps the stack for the errors, then records into the thread buffer
+    run("trace_span_stack_only", [](unsigned long long) {
+        NGO_TRACE_SPAN("bench.span");
+    });
+    run("trace_span_recorded", [](unsigned long long i) {
+        // a new session every 4096 spans, so that none is dropped
+        if ((i & 4095) == 0)
+            NgoTrace::start(1<<13);
+        NGO_TRACE_SPAN("bench.span");
+    });
+    NgoTrace::stop();
+}
+
+/*******************************************************************************
+   ERROR BENCHMARKS
+*******************************************************************************/
+template <class E>
+void benchThrow(const std::string & name)
+{
+    run("throw_catch_" + name, [](unsigned long long) {
+        try
+        {
+            throw E();
+        }
+        catch (NgoError & er)
+        {
+            // every error has a code, E_UNKNOWN for a plain NgoError
+            if (er.getCode() == E_OK)
+                abort();
+        }
+    });
+}
+
+void benchErrors()
+{
+    benchThrow<NgoError>("NgoError");
+    benchThrow<NgoErrorUnknown>("NgoErrorUnknown");
+    benchThrow<NgoErrorData>("NgoErrorData");
+    benchThrow<NgoErrorImplementation>("NgoErrorImplementation");
+    benchThrow<NgoErrorComputation>("NgoErrorComputation");
+    benchThrow<NgoErrorBadArgument>("NgoErrorBadArgument");
+    benchThrow<NgoErrorLicenceError>("NgoErrorLicenceError");
+    benchThrow<NgoErrorInvalidArgument>("NgoErrorInvalidArgument");
+    benchThrow<NgoErrorThrmPropertyNotAvailable>("NgoErrorThrmPropertyNotAvailable");
+    benchThrow<NgoErrorOutOfBounds>("NgoErrorOutOfBounds");
+    benchThrow<NgoErrorSolving>("NgoErrorSolving");
+    benchThrow<NgoErrorFailedInitialisation>("NgoErrorFailedInitialisation");
+    benchThrow<NgoErrorInvalidOperation>("NgoErrorInvalidOperation");
+    benchThrow<NgoErrorNoImpl>("NgoErrorNoImpl");
+    benchThrow<NgoErrorLimitedImpl>("NgoErrorLimitedImpl");
+    benchThrow<NgoErrorBadInvOrder>("NgoErrorBadInvOrder");
+
+    static const int depths[] = {1, 8, 32};
+    for (unsigned d=0;d<sizeof(depths)/sizeof(depths[0]);d++)
+    {
+        const int depth = depths[d];
+        char name[64];
+        sprintf(name,"add_scope_error_depth_%d",depth);
+        run(name, [depth](unsigned long long) {
+            try
+            {
+                NgoErrorSolving er("no convergence","flash");
+                for (int i=0;i<depth;i++)
+                    er.addScopeError("solver");
+                throw er;
+            }
+            catch (NgoError & er)
+            {
+                if (er.getScope().empty())
+                    abort();
+            }
+        });
+    }
+
+    // rendering: first what() formats into the cache, the next ones return it
+    run("render_out_of_bounds_first", [](unsigned long long) {
+        NgoErrorOutOfBounds er(1500.25,200.,1e5,"temperature",2,"too hot","flash");
+        if (!*er.what())
+            abort();
+    });
+    NgoErrorOutOfBounds cached(1500.25,200.,1e5,"temperature",2,"too hot","flash");
+    run("render_out_of_bounds_cached", [&cached](unsigned long long) {
+        if (!*cached.what())
+            abort();
+    });
+
+    // raised through the base class: raise copies the strings into the exception, rethrow moves them
+    const std::string description(256,'d');
+    run("raise_copy", [&description](unsigned long long) {
+        NgoErrorSolving solving(description,"flash->solver->newton","ICapeThermo","CalcEquilibrium");
+        NgoError & er = solving;
+        try
+        {
+            er.raise();
+        }
+        catch (NgoErrorSolving &)
+        {
+        }
+    });
+    run("rethrow_move", [&description](unsigned long long) {
+        NgoErrorSolving solving(description,"flash->solver->newton","ICapeThermo","CalcEquilibrium");
+        NgoError & er = solving;
+        try
+        {
+            er.rethrow();
+        }
+        catch (NgoErrorSolving &)
+        {
+        }
+    });
+    run("exception_ptr_copy", [&description](unsigned long long) {
+        NgoErrorSolving solving(description,"flash->solver->newton","ICapeThermo","CalcEquilibrium");
+        std::exception_ptr ptr = std::make_exception_ptr(solving);
+        if (!ptr)
+            abort();
+    });
+    run("exception_ptr_move", [&description](unsigned long long) {
+        NgoErrorSolving solving(description,"flash->solver->newton","ICapeThermo","CalcEquilibrium");
+        std::exception_ptr ptr = solving.exceptionPtr();
+        if (!ptr)
+            abort();
+    });
+}
+
+/*******************************************************************************
+   COLLECTOR BENCHMARKS
+*******************************************************************************/
+void benchCollector()
+{
+    NgoErrorCollector collector;
+    const std::exception_ptr failure = NgoErrorSolving("no convergence","flash").exceptionPtr();
+    const unsigned maxThreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 1;
+    for (unsigned threads=1;;threads*=2)
+    {
+        if (threads > maxThreads)
+            threads = maxThreads;
+        char suffix[32];
+        sprintf(suffix,"_threads_%u",threads);
+        // the push alone, of an exception already caught
+        runThreads(std::string("collector_add_ptr") + suffix, threads, [&collector,&failure](unsigned long long) {
+            collector.add(failure);
+        }, [&collector]() { collector.clear(); });
+        // tasks failing at once: the throw dominates, addCurrent adds no other
+        runThreads(std::string("collector_throw_add_current") + suffix, threads, [&collector](unsigned long long) {
+            try
+            {
+                throw NgoErrorSolving("no convergence","flash");
+            }
+            catch (...)
+            {
+                collector.addCurrent();
+            }
+        }, [&collector]() { collector.clear(); });
+        // add of the error caught rethrows it to compare the addresses
+        runThreads(std::string("collector_throw_add_error") + suffix, threads, [&collector](unsigned long long) {
+            try
+            {
+                throw NgoErrorSolving("no convergence","flash");
+            }
+            catch (NgoError & er)
+            {
+                collector.add(er);
+            }
+        }, [&collector]() { collector.clear(); });
+        if (threads == maxThreads)
+            break;
+    }
+    // the join looks up the error of each exception
+    run("collector_groups_1k", [&collector,&failure](unsigned long long) {
+        for (int i=0;i<1000;i++)
+            collector.add(failure);
+        if (collector.groups().size() != 1)
+            abort();
+        collector.clear();
+    });
+}
+
+/*******************************************************************************
+   C INTERFACE BENCHMARKS
+*******************************************************************************/
+/*! @brief an entry point of a C interface, failing when fail is true */
+int benchEntryPoint(volatile int * counter, bool fail)
+{
+    NGO_C_API_BEGIN
+        if (fail)
+            throw NgoErrorSolving("no convergence","flash");
+        ++*counter;
+    NGO_C_API_END
+}
+
+void benchCInterface()
+{
+    static volatile int counter = 0;
+    run("c_api_entry_success", [](unsigned long long) {
+        if (benchEntryPoint(&counter,false) != E_OK)
+            abort();
+    });
+    run("c_api_entry_error", [](unsigned long long) {
+        if (benchEntryPoint(&counter,true) != E_SOLVINGERROR)
+            abort();
+    });
+}
+
+/*******************************************************************************
+   CHECKS BENCHMARKS
+*******************************************************************************/
+/*! @brief the element by element loop used before NgoCheckBounds */
+void scalarCheckBounds(const double * values, size_t n, double lower, double upper)
+{
+    for (size_t i=0;i<n;i++)
+        if (!(values[i] >= lower && values[i] <= upper))
+            throw NgoErrorOutOfBounds(values[i],lower,upper,"temperature",1);
+}
+
+void benchChecks()
+{
+    const size_t n = 100000;
+    std::vector<double> values(n), lower(n,200.), upper(n,1000.);
+    for (size_t i=0;i<n;i++)
+        values[i] = 300. + (i%100);
+    const double * v = &values[0];
+    const double * lo = &lower[0];
+    const double * hi = &upper[0];
+
+    std::string isa = NgoErrorChecksInstructionSet();
+    run("check_bounds_100k_scalar_loop", [v](unsigned long long) {
+        scalarCheckBounds(v,n,200.,1000.);
+    });
+    run("check_bounds_100k_" + isa, [v](unsigned long long) {
+        NgoCheckBounds(v,n,200.,1000.,"temperature",1);
+    });
+    run("check_bounds_100k_arrays_scalar_loop", [v,lo,hi](unsigned long long) {
+        for (size_t i=0;i<n;i++)
+            if (!(v[i] >= lo[i] && v[i] <= hi[i]))
+                throw NgoErrorOutOfBounds(v[i],lo[i],hi[i],"temperature",1);
+    });
+    run("check_bounds_100k_arrays_" + isa, [v,lo,hi](unsigned long long) {
+        NgoCheckBounds(v,n,lo,hi,"temperature",1);
+    });
+    run("check_finite_100k_scalar_loop", [v](unsigned long long) {
+        for (size_t i=0;i<n;i++)
+            if (std::isnan(v[i]) || std::isinf(v[i]))
+                throw NgoErrorComputation("non finite value");
+    });
+    run("check_finite_100k_" + isa, [v](unsigned long long) {
+        NgoCheckFinite(v,n);
+    });
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char ** argv)
+{
+    for (int i=1;i<argc;i++)
+    {
+        if (strncmp(argv[i],"--min-time=",11) == 0)
+            g_minTime = atof(argv[i]+11);
+        else
+            g_filter = argv[i];
+    }
+    benchLogging();
+    benchErrors();
+    benchCollector();
+    benchCInterface();
+    benchChecks();
+    return 0;
+}
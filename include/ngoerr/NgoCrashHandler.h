@@ -0,0 +1,69 @@
+#ifndef _NgoCrashHandler_h
+#define _NgoCrashHandler_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoCrashHandler.h
+@date October 2026
+@brief File containing the emergency flush of the last logs on a fatal signal.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+#include <stddef.h>
+
+#include "ngoerr/NgoError.h"
+
+/*******************************************************************************
+   CLASS NgoCrashHandler DECLARATION
+*******************************************************************************/
+/*!
+@class NgoCrashHandler
+@brief Emergency flush of the logs when the process dies on a fatal signal.
+
+Once installed, every log dispatched by the logger manager is also copied in a preallocated ring
+holding the last logged bytes. Those are the records that may still sit in stdio buffers, in
+@ref NgoLoggerFilename or in @ref NgoLoggerBufferedString when the process crashes.
+On a fatal signal, the handler writes the ring to the file descriptor given at installation,
+using only async-signal-safe calls, without lock nor allocation. The previous disposition of the
+signal is then restored and the signal is raised again, so core dumps and parent processes see
+the original cause of the death.
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoCrashHandler
+{
+public:
+    /*! @brief installs the handler */
+    /*! @param fd file descriptor opened beforehand, where the last logs are written on a crash */
+    /*! @param ringSize number of last logged bytes to keep */
+    /*! @param signals array of signals to handle. If null, SIGSEGV, SIGABRT, SIGFPE, SIGILL and SIGBUS are handled */
+    /*! @param nSignals size of signals array */
+    static void install(int fd, size_t ringSize=64*1024, const int * signals=0L, int nSignals=0);
+    /*! @brief uninstalls the handler and restores the previous dispositions of the signals */
+    /*! The ring is kept allocated until the exit, as threads logging concurrently may still be
+    copying into it. */
+    static void uninstall();
+    /*! @brief returns true if the handler is installed */
+    static bool isInstalled();
+    /*! @brief writes the ring to the file descriptor. This method is async-signal-safe and can be
+    called from a user handler */
+    static void emergencyFlush();
+    /*! @brief copies a log in the ring. Called by the logger manager, also without its lock when the
+    logs are appended to thread buffers: the ring is published with its size by a single atomic
+    pointer, and each log reserves its bytes of the ring, so a crash during the copy only leaves
+    that log incomplete */
+    static void record(const char * log, size_t length);
+};
+
+#endif // _NgoCrashHandler_h
@@ -44,6 +44,7 @@ and the current @ref grp_eos_avl "available descriptions".
 /*******************************************************************************
    INCLUDES
 *******************************************************************************/
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -110,6 +111,9 @@ E_PERSISTENCEOVERFLOW,  /*!< There is an overflow of internal persistence system
 E_THRMPROPERTYNOTAVAILABLE  /*!< A requested thermodynamic property is not available in stored data. */
 } e_NgoErrorCode;
 
+/*! @brief number of trace spans kept by an error for its scope, the innermost ones */
+#define NGO_ERR_MAX_SPANS 8
+
 /*******************************************************************************
    GLOBAL VARIABLES
 *******************************************************************************/
@@ -121,9 +125,15 @@ E_THRMPROPERTYNOTAVAILABLE  /*!< A requested thermodynamic property is not avail
 /*!
 @class NgoError
 @brief The base class of the errors hierarchy. This is an abstract class. No real error can be raised from this class.
+It derives from std::exception, so a catch of std::exception handles the errors too.
+
+An error is raised with its dynamic type by rethrow(), which moves it into the exception thrown,
+or by raise(), which copies it. clone() copies it with its dynamic type, and exceptionPtr() moves
+it into a std::exception_ptr, to be sent to another thread and rethrown there with
+std::rethrow_exception, without copying its strings.
 @ingroup grp_err
 */
-class NGO_ERR_EXPORT NgoError
+class NGO_ERR_EXPORT NgoError : public std::exception
 {
 public :
    /*! @brief Constructor */
@@ -140,6 +150,11 @@ public :
 
       /*! @brief Destructor */
    virtual ~NgoError(){};
+   /*! @brief Copy and move, declared as the destructor is */
+   NgoError(const NgoError &) = default;
+   NgoError(NgoError &&) = default;
+   NgoError & operator =(const NgoError &) = default;
+   NgoError & operator =(NgoError &&) = default;
 
    /*! @brief Add scope of error */
    /*! @param scope input function scope that will be add to the current scope of error */
@@ -154,21 +169,57 @@ public :
 
    /*! @brief Getter of code error */
    /*! @return NgoError code */
-   int getCode() { return code_;};
+   int getCode() const { return code_;};
 
    /*! @brief Function to format NgoError print output */
+   /*! Writes the text returned by what(). */
    virtual void print(std::ostream& os) const;
 
+   /*! @brief Rendered text of the error */
+   /*! The text is rendered once by render() and cached on the error, so repeated calls
+   (logging, rethrow handlers, print) cost a pointer return. addScopeError() and addDescription()
+   invalidate the cache. The first call mutates the error: it must not race with another
+   thread using the same object. exceptionPtr() and @ref NgoErrorCollector render the error
+   before sharing it, so the threads rethrowing it only read the cache. */
+   /*! @return pointer valid until the error is modified or destroyed */
+   virtual const char * what() const noexcept;
+
    /*! @brief Function to get error description */
    std::string getDescription() const {return description_;};
 
-   /*! @brief Function to get error description */
-   std::string getScope() const {return scope_;};
+   /*! @brief Function to get error scope */
+   /*! The names of the trace spans the error was built in come first, joined with "->". */
+   std::string getScope() const;
 
    /*! @brief virtual method to raise a polymorphic exception */
+   /*! The error is copied into the exception thrown */
    virtual void raise() { throw *this;};
 
+   /*! @brief copy of the error with its dynamic type */
+   /*! @return new error, to be deleted by the caller */
+   virtual NgoError * clone() const { return new NgoError(*this);};
+
+   /*! @brief raises the error with its dynamic type, moving it into the exception thrown */
+   /*! The error is left empty: it is meant for an error which is no longer used, such as a
+   clone or an error built to be raised. */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
+
+   /*! @brief moves the error into an exception_ptr, keeping its dynamic type */
+   /*! The text of what() is rendered first, so that the threads sharing the exception only read
+   it. The error is left empty, as by rethrow. It is moved by a throw, which costs more than
+   copying a few short strings: in the handler of the error, std::current_exception() gives
+   the exception_ptr without either. */
+   std::exception_ptr exceptionPtr();
+
 protected :
+   /*! @brief Append the text of the error to out */
+   /*! Derived classes adding state override this method rather than print(),
+   calling the parent implementation first. Those writing numbers also override print(), so that
+   a stream formats them with its own flags and precision. */
+   virtual void render(std::string & out) const;
+   /*! @brief Append the scope of the error to out, spans included */
+   void appendScope(std::string & out) const;
+
    /*! @brief A short description of the error. */
    std::string name_;
    /*! @brief Code to designate the subcategory of the error. @sa e_NgoErrorCode */
@@ -178,12 +229,18 @@ protected :
    std::string description_;
    /*! @brief The scope of the error. The list of packages where the error occurs separated by ':' */
    std::string scope_;
+   /*! @brief Names of the innermost trace spans the error was built in, from the outermost */
+   const char * spans_[NGO_ERR_MAX_SPANS];
+   /*! @brief Depth of the span stack when the error was built, greater than NGO_ERR_MAX_SPANS if spans are left out */
+   unsigned spanDepth_;
    /*! @brief The name of the interface where the error is thrown. */
    std::string interfaceName_;
    /*! @brief The name of the operation where the error is thrown*/
    std::string operation_;
    /*! @brief A string giving more information */
    std::string moreInfo_;
+   /*! @brief Cache of the rendered text, empty until what() is called */
+   mutable std::string text_;
 };
 
 inline std::ostream& operator << (std::ostream& os, const NgoError& E)
@@ -212,11 +269,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorUnknown(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorUnknown * clone() const { return new NgoErrorUnknown(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -244,6 +302,11 @@ public :
 
    /*! @brief Destructor */
    virtual ~NgoErrorBoundaries(){};
+   /*! @brief Copy and move, declared as the destructor is */
+   NgoErrorBoundaries(const NgoErrorBoundaries &) = default;
+   NgoErrorBoundaries(NgoErrorBoundaries &&) = default;
+   NgoErrorBoundaries & operator =(const NgoErrorBoundaries &) = default;
+   NgoErrorBoundaries & operator =(NgoErrorBoundaries &&) = default;
 
    /*! @copydoc NgoError::print */
    virtual void print(std::ostream& os) const;
@@ -252,6 +315,9 @@ public :
    virtual void raise() { throw *this;};
 
 protected :
+   /*! @brief Append the description of the value and its bounds to out */
+   void renderBoundaries(std::string & out) const;
+
    /*! @brief The current value which has led to an error. */
    double value_;
    /*! @brief The value of the lower bound. */
@@ -282,11 +348,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorData(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorData * clone() const { return new NgoErrorData(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 
@@ -310,11 +377,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorImplementation(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorImplementation * clone() const { return new NgoErrorImplementation(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -337,11 +405,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorComputation(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorComputation * clone() const { return new NgoErrorComputation(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 
@@ -367,14 +436,15 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorBadArgument(){};
-
-   /*! @copydoc NgoError::print */
-   virtual void print(std::ostream& os) const;
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorBadArgument * clone() const { return new NgoErrorBadArgument(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
+protected :
+   /*! @copydoc NgoError::render */
+   virtual void render(std::string & out) const;
 private :
    int position_;
 };
@@ -399,11 +469,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorLicenceError(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorLicenceError * clone() const { return new NgoErrorLicenceError(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 
@@ -428,11 +499,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorInvalidArgument(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorInvalidArgument * clone() const { return new NgoErrorInvalidArgument(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -456,11 +528,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorThrmPropertyNotAvailable(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorThrmPropertyNotAvailable * clone() const { return new NgoErrorThrmPropertyNotAvailable(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -490,14 +563,20 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorOutOfBounds(){};
-
-   /*! @copydoc NgoError::print */
+   /*! @brief Function to format NgoError print output */
+   /*! Writes the text returned by what(), but the value and its bounds are written with the
+   format of the stream: the scientific notation with 5 digits in a NgoLog. */
    virtual void print(std::ostream& os) const;
 
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorOutOfBounds * clone() const { return new NgoErrorOutOfBounds(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
+protected :
+   /*! @copydoc NgoError::render */
+   virtual void render(std::string & out) const;
 };
 
 /*******************************************************************************
@@ -520,11 +599,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorSolving(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorSolving * clone() const { return new NgoErrorSolving(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -547,11 +627,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorFailedInitialisation(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorFailedInitialisation * clone() const { return new NgoErrorFailedInitialisation(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -574,11 +655,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorInvalidOperation(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorInvalidOperation * clone() const { return new NgoErrorInvalidOperation(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -601,11 +683,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorNoImpl(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorNoImpl * clone() const { return new NgoErrorNoImpl(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -628,11 +711,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorLimitedImpl(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorLimitedImpl * clone() const { return new NgoErrorLimitedImpl(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 };
 
 /*******************************************************************************
@@ -657,11 +741,12 @@ public :
       std::string oper  =""
       );
 
-   /*! @brief Destructor */
-   virtual ~NgoErrorBadInvOrder(){};
-
    /*! @brief virtual method to raise a polymorphic exception */
    virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorBadInvOrder * clone() const { return new NgoErrorBadInvOrder(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
 
 protected:
    std::string requestedOperatation_;
@@ -0,0 +1,144 @@
+#ifndef _NgoErrorChecks_h
+#define _NgoErrorChecks_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoErrorChecks.h
+@date October 2026
+@brief File containing vectorized checks of arrays of values, raising the matching errors on failure.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   DOXYGEN GROUP DEFINION
+*******************************************************************************/
+/*! @defgroup grp_err_checks Checks of arrays
+@ingroup grp_err
+@brief This section describes the vectorized checks of arrays.
+The checks use AVX or SSE2 instructions when the processor supports them, and a scalar loop
+otherwise. The errors are only built when a check fails.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoError.h"
+
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+/*! @brief index returned when no element is found */
+/*! @ingroup grp_err_checks */
+const size_t NGO_NPOS = (size_t)-1;
+
+/*******************************************************************************
+   BOUNDS CHECKS
+*******************************************************************************/
+/*! @brief returns the name of the instruction set used by the checks ("avx", "sse2" or "scalar") */
+/*! @ingroup grp_err_checks */
+NGO_ERR_EXPORT const char * NgoErrorChecksInstructionSet();
+
+/*! @brief returns the index of the first value out of [lower,upper], or NGO_NPOS
+A NaN value is always out of bounds. Use infinite bounds for a one-sided check.
+@param values array of values
+@param n size of the array
+@param lower lower bound
+@param upper upper bound
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindFirstOutOfBounds(const double * values, size_t n, double lower, double upper);
+
+/*! @brief returns the index of the first value out of [lower[i],upper[i]], or NGO_NPOS
+@param values array of values
+@param n size of the arrays
+@param lower array of lower bounds
+@param upper array of upper bounds
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindFirstOutOfBounds(const double * values, size_t n, const double * lower, const double * upper);
+
+/*! @brief appends the indices of all values out of [lower,upper] and returns their number
+@copydetails NgoFindFirstOutOfBounds(const double *,size_t,double,double)
+@param indices vector where the indices are appended
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindOutOfBounds(const double * values, size_t n, double lower, double upper, std::vector<size_t> & indices);
+
+/*! @brief appends the indices of all values out of [lower[i],upper[i]] and returns their number
+@copydetails NgoFindFirstOutOfBounds(const double *,size_t,const double *,const double *)
+@param indices vector where the indices are appended
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindOutOfBounds(const double * values, size_t n, const double * lower, const double * upper, std::vector<size_t> & indices);
+
+/*! @brief raises a NgoErrorOutOfBounds for the first value out of [lower,upper], if any
+@copydetails NgoFindFirstOutOfBounds(const double *,size_t,double,double)
+@param type type/nature of the values
+@param position position of the array in the arguments of the operation
+@param scope scope of the error
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT void NgoCheckBounds(const double * values, size_t n, double lower, double upper,
+                                   const std::string & type="", int position=0, const std::string & scope="");
+
+/*! @brief raises a NgoErrorOutOfBounds for the first value out of [lower[i],upper[i]], if any
+@copydetails NgoFindFirstOutOfBounds(const double *,size_t,const double *,const double *)
+@param type type/nature of the values
+@param position position of the array in the arguments of the operation
+@param scope scope of the error
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT void NgoCheckBounds(const double * values, size_t n, const double * lower, const double * upper,
+                                   const std::string & type="", int position=0, const std::string & scope="");
+
+/*******************************************************************************
+   NON FINITE VALUES CHECKS
+*******************************************************************************/
+/*! @enum NgoNonFiniteKind : kinds of non finite values, to combine as flags */
+/*! @ingroup grp_err_checks */
+enum NgoNonFiniteKind
+{
+    NGO_NAN       = 1, /*!< a NaN other than @ref UNDEFERR, usually the result of an invalid operation */
+    NGO_INF       = 2, /*!< a positive or negative infinity */
+    NGO_UNDEFERR  = 4, /*!< the sentinel @ref UNDEFERR of undefined values */
+    NGO_NONFINITE = 7  /*!< any non finite value */
+};
+
+/*! @brief returns the kind of a value, or 0 if it is finite */
+/*! @ingroup grp_err_checks */
+NGO_ERR_EXPORT int NgoNonFiniteKindOf(double value);
+
+/*! @brief returns the index of the first value of the given kinds, or NGO_NPOS
+The array is scanned for non finite values with vector instructions, at memory bandwidth,
+and only the non finite values are classified.
+@param values array of values
+@param n size of the array
+@param kinds combination of @ref NgoNonFiniteKind
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindFirstNonFinite(const double * values, size_t n, int kinds=NGO_NONFINITE);
+
+/*! @brief appends the indices of all values of the given kinds and returns their number
+@copydetails NgoFindFirstNonFinite
+@param indices vector where the indices are appended
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT size_t NgoFindNonFinite(const double * values, size_t n, std::vector<size_t> & indices, int kinds=NGO_NONFINITE);
+
+/*! @brief raises a NgoErrorComputation describing the first value of the given kinds, if any
+@copydetails NgoFindFirstNonFinite
+@param type type/nature of the values
+@param scope scope of the error
+@ingroup grp_err_checks */
+NGO_ERR_EXPORT void NgoCheckFinite(const double * values, size_t n, int kinds=NGO_NONFINITE,
+                                   const std::string & type="", const std::string & scope="");
+
+#endif // _NgoErrorChecks_h
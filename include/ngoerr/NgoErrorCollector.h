@@ -0,0 +1,183 @@
+#ifndef _NgoErrorCollector_h
+#define _NgoErrorCollector_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoErrorCollector.h
+@date October 2026
+@brief File containing a collector of the errors raised by parallel computations.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <atomic>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoError.h"
+
+/*******************************************************************************
+   CLASS NgoErrorComposite DECLARATION
+*******************************************************************************/
+/*!
+@class NgoErrorComposite
+@ingroup grp_err_avl
+@brief The error raised by @ref NgoErrorCollector when several errors have been collected.
+Its code is the one of the most severe collected error, and its description summarises the
+errors grouped by code and scope. The collected errors can be rethrown one by one from errors().
+*/
+class NGO_ERR_EXPORT NgoErrorComposite : public NgoError
+{
+public :
+   /*! @brief Constructor */
+   /*! @param code code of the most severe error */
+   /*! @param errors collected errors */
+   /*! @copydetails NgoError::NgoError */
+   NgoErrorComposite(
+      e_NgoErrorCode code = E_UNKNOWN,
+      const std::vector<std::exception_ptr> & errors = std::vector<std::exception_ptr>(),
+      std::string desc  ="Several errors occured",
+      std::string scope ="",
+      std::string ifc   ="",
+      std::string oper  =""
+      );
+
+   /*! @brief collected errors */
+   const std::vector<std::exception_ptr> & errors() const {return errors_;};
+
+   /*! @brief virtual method to raise a polymorphic exception */
+   virtual void raise() { throw *this;};
+   /*! @copydoc NgoError::clone */
+   virtual NgoErrorComposite * clone() const { return new NgoErrorComposite(*this);};
+   /*! @copydoc NgoError::rethrow */
+   [[noreturn]] virtual void rethrow() { throw std::move(*this);};
+
+protected :
+   /*! @brief collected errors */
+   std::vector<std::exception_ptr> errors_;
+};
+
+/*******************************************************************************
+   CLASS NgoErrorCollector DECLARATION
+*******************************************************************************/
+/*!
+@class NgoErrorCollector
+@ingroup grp_err
+@brief Collects the errors caught by many threads, and raises them at the join point.
+
+Workers add the exception they are handling from their catch block with addCurrent. The exception
+object itself is kept alive through std::current_exception, so adding an error copies neither the
+error nor its strings, and throws nothing: the NgoError of each exception is only looked up at the
+join point, by groups or rethrow. Adding is lock-free: errors are pushed on one of several lists,
+chosen per thread, to keep the contention low when thousands of tasks fail at the same time.
+@code
+NgoErrorCollector collector;
+// in each worker
+try { flash(i); }
+catch (...) { collector.addCurrent(); }
+// at the join point
+collector.rethrow(NgoErrorCollector::COMPOSITE);
+@endcode
+*/
+class NGO_ERR_EXPORT NgoErrorCollector
+{
+public :
+   /*! @brief policy of rethrow */
+   enum Policy
+   {
+      MOST_SEVERE, /*!< the most severe collected error is rethrown with its dynamic type */
+      COMPOSITE    /*!< a single error is rethrown as it is, several errors as a NgoErrorComposite */
+   };
+
+   /*! @brief a group of collected errors sharing the same code and scope */
+   struct Group
+   {
+      /*! @brief code of the errors */
+      int code;
+      /*! @brief scope of the errors */
+      std::string scope;
+      /*! @brief number of errors */
+      unsigned count;
+      /*! @brief an error of the group, to describe it. An exception which is not a NgoError is
+      described by a NgoErrorUnknown holding its message */
+      const NgoError * first;
+   };
+
+   /*! @brief Constructor */
+   NgoErrorCollector();
+   /*! @brief Destructor */
+   ~NgoErrorCollector();
+
+   /*! @brief adds the exception handled by the calling catch block, if any. Can be called
+   concurrently from many threads */
+   void addCurrent();
+   /*! @brief adds an exception. Can be called concurrently from many threads */
+   /*! @param exception exception, a NgoError or not, ignored if null */
+   void add(std::exception_ptr exception);
+   /*! @brief adds an error. Can be called concurrently from many threads */
+   /*! @param er error, kept without copy if it is the exception handled by the calling catch
+   block, caught by reference. Otherwise (another error, a copy caught by value, or no exception
+   handled), it is copied with its dynamic type. Telling the two apart rethrows the exception
+   handled, and the copy throws again: addCurrent is cheaper from a catch block */
+   void add(const NgoError & er);
+
+   /*! @brief returns true if no error has been collected */
+   bool empty() const;
+   /*! @brief number of collected errors. Not to be called while errors are being added */
+   size_t size() const;
+   /*! @brief errors grouped by code and scope, the most severe first. Not to be called while errors are being added */
+   std::vector<Group> groups() const;
+   /*! @brief removes all collected errors */
+   void clear();
+
+   /*! @brief rethrows the collected errors according to the policy, if any, and empties the collector */
+   /*! Not to be called while errors are being added */
+   void rethrow(Policy policy = MOST_SEVERE);
+
+private :
+   NgoErrorCollector(const NgoErrorCollector&);
+   NgoErrorCollector& operator =(const NgoErrorCollector&);
+
+   /*! @brief collected error */
+   struct Node
+   {
+      std::exception_ptr exception;
+      /*! @brief NgoErrorUnknown describing an exception which is not a NgoError */
+      std::exception_ptr unknown;
+      /*! @brief error of the exception, looked up at the join point */
+      const NgoError * error;
+      Node * next;
+   };
+   /*! @brief number of lists */
+   static const unsigned SHARDS = 16;
+   /*! @brief head of a list, alone on its cache line */
+   struct alignas(64) Shard
+   {
+      std::atomic<Node *> head;
+   };
+   Shard shards_[SHARDS];
+
+   /*! @brief pushes a node on the list of the calling thread */
+   void push(Node * node);
+   /*! @brief looks up the error of the exception of a node */
+   static void resolve(Node & node);
+   /*! @brief collected errors, the most severe first */
+   std::vector<Node *> sorted() const;
+};
+
+#endif // _NgoErrorCollector_h
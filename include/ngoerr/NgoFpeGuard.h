@@ -0,0 +1,113 @@
+#ifndef _NgoFpeGuard_h
+#define _NgoFpeGuard_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoFpeGuard.h
+@date October 2026
+@brief File containing a guard converting floating point exceptions of a region into errors.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <fenv.h>
+#include <string>
+
+#include "ngoerr/NgoError.h"
+
+/*******************************************************************************
+   CLASS NgoFpeGuard DECLARATION
+*******************************************************************************/
+/*!
+@class NgoFpeGuard
+@ingroup grp_err
+@brief Guard raising a @ref NgoErrorComputation when floating point exceptions occur in its region.
+
+The guard clears the floating point exception flags on construction. When it is destroyed, or when
+check is called, the flags raised meanwhile are converted into a NgoErrorComputation carrying the
+scope of the guard, so hot kernels need no check after each operation.
+In TRAP mode, the exceptions raise SIGFPE: the first faulting instruction is recorded and the
+computation goes on with the exceptions masked, to report where the failure happened.
+TRAP mode is available with glibc on x86-64, other platforms fall back to FLAGS mode.
+The floating point environment in effect before the guard is restored on destruction, except the
+flags raised in the region that the guard does not watch, which are left to the enclosing guards.
+@code
+{
+   NgoFpeGuard guard("flash::solve");
+   solve(); // no check of intermediate results
+}  // raises NgoErrorComputation if solve produced NaN, a division by zero or an overflow
+@endcode
+The destructor does not raise when the region is left by another exception.
+*/
+class NGO_ERR_EXPORT NgoFpeGuard
+{
+public :
+   /*! @brief mode of detection of the exceptions */
+   enum Mode
+   {
+      FLAGS, /*!< the exception flags are tested on exit */
+      TRAP   /*!< the exceptions are trapped when they occur */
+   };
+
+   /*! @brief Constructor */
+   /*! @param scope scope given to the error. It must outlive the guard, a string literal usually */
+   /*! @param excepts combination of FE_INVALID, FE_DIVBYZERO, FE_OVERFLOW, FE_UNDERFLOW and FE_INEXACT */
+   /*! @param mode mode of detection */
+   NgoFpeGuard(
+      const char * scope = "",
+      int excepts = FE_INVALID|FE_DIVBYZERO|FE_OVERFLOW,
+      Mode mode = FLAGS
+      );
+
+   /*! @brief Destructor. Restores the environment and raises the exceptions which occured */
+   ~NgoFpeGuard() noexcept(false);
+
+   /*! @brief returns the guarded exceptions raised since the construction or the last check */
+   int raised() const;
+
+   /*! @brief raises a NgoErrorComputation if guarded exceptions have been raised, and clears them */
+   void check();
+
+   /*! @brief returns true if the guard runs in TRAP mode */
+   bool trapping() const {return trap_;};
+
+private :
+   NgoFpeGuard(const NgoFpeGuard&);
+   NgoFpeGuard& operator =(const NgoFpeGuard&);
+
+   /*! @brief builds and raises the error */
+   /*! @param flags raised exceptions */
+   /*! @param address address of the first trapped instruction, if any */
+   void raise(int flags, void * address);
+
+   /*! @brief scope given to the error */
+   const char * scope_;
+   /*! @brief guarded exceptions */
+   int excepts_;
+   /*! @brief true in TRAP mode */
+   bool trap_;
+   /*! @brief number of exceptions in flight on construction */
+   int uncaught_;
+   /*! @brief environment restored on destruction */
+   fenv_t saved_;
+   /*! @brief enclosing trapping guard of the thread */
+   NgoFpeGuard * previous_;
+   /*! @brief first trapped instruction of the enclosing trapping guard */
+   void * previousAddress_;
+};
+
+#endif // _NgoFpeGuard_h
@@ -0,0 +1,128 @@
+#ifndef _NgoLastError_h
+#define _NgoLastError_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLastError.h
+@date October 2026
+@brief File containing the last error of a thread, used to report errors through a C interface
+without throwing exceptions across the library boundary.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include "ngoerr/NgoError.h"
+
+/*******************************************************************************
+   DOXYGEN GROUP DEFINION
+*******************************************************************************/
+/*! @defgroup grp_err_c C interface
+@ingroup grp_err
+@brief This section describes how errors are reported to C and Fortran callers
+
+Each thread has a last error. An entry point of the C interface catches the exceptions raised by
+its body, stores them as the last error of the thread and returns their code. The caller tests the
+returned code and queries the last error only when it is not E_OK:
+@code
+int NGO_ERR_EXPORT ngoFlash(double T, double P)
+{
+   NGO_C_API_BEGIN
+      flash(T,P);
+   NGO_C_API_END
+}
+@endcode
+@code
+if (ngoFlash(T,P) != E_OK)
+   fprintf(stderr,"%s\n",NgoGetLastErrorDescription());
+@endcode
+The success path only costs the return of E_OK: the try block has no runtime cost with table based
+exception handling, and the last error is neither read nor cleared.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief code of the last error of the calling thread */
+/*! @return a value of @ref e_NgoErrorCode, E_OK if no error was stored since the last clear */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT int NgoGetLastErrorCode();
+
+/*! @brief description of the last error of the calling thread */
+/*! @return borrowed pointer, valid until the next error is stored or cleared on this thread. Never null */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT const char * NgoGetLastErrorDescription();
+
+/*! @brief scope of the last error of the calling thread */
+/*! @copydetails NgoGetLastErrorDescription */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT const char * NgoGetLastErrorScope();
+
+/*! @brief full text of the last error of the calling thread, as given by NgoError::what */
+/*! @copydetails NgoGetLastErrorDescription */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT const char * NgoGetLastErrorText();
+
+/*! @brief reset the last error of the calling thread to E_OK */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT void NgoClearLastError();
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif // end of ifdef __cplusplus
+
+/*! @brief store an error as the last error of the calling thread */
+/*! @param er error whose code, description, scope and text are copied */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT void NgoSetLastError(const NgoError & er);
+
+/*! @brief store the exception being handled as the last error of the calling thread */
+/*! Must be called from a catch block. A NgoError is stored as is, with E_UNKNOWN if its code is
+E_OK, std::bad_alloc as E_NOMEMORY, other exceptions as E_UNKNOWN with the text of
+std::exception::what when available. */
+/*! @return the code of the stored error */
+/*! @ingroup grp_err_c */
+NGO_ERR_EXPORT int NgoSetLastErrorFromCurrentException();
+
+/*! @brief opens the body of an entry point of the C interface returning an error code */
+/*! @ingroup grp_err_c */
+#define NGO_C_API_BEGIN \
+    try {
+
+/*! @brief closes the body opened by NGO_C_API_BEGIN */
+/*! Returns E_OK when the body completes, the code of the error otherwise. The handling of the
+exception is out of line so that each entry point only contains a call in its landing pad. */
+/*! @ingroup grp_err_c */
+#define NGO_C_API_END \
+    } \
+    catch (...) { \
+        return NgoSetLastErrorFromCurrentException(); \
+    } \
+    return E_OK;
+
+/*! @brief calls a function object translating its exceptions into the last error */
+/*! @return E_OK, or the code of the error raised by f */
+/*! @ingroup grp_err_c */
+template <class F>
+inline int NgoCallNoThrow(F f)
+{
+    NGO_C_API_BEGIN
+        f();
+    NGO_C_API_END
+}
+
+#endif // _NgoLastError_h
@@ -0,0 +1,87 @@
+#ifndef _NgoLogConfig_h
+#define _NgoLogConfig_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLogConfig.h
+@date October 2026
+@brief File containing the configuration of the log levels at runtime, from the environment or a file.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <string>
+
+#include "ngoerr/NgoLogging.h"
+
+/*! @brief environment variable holding the levels applied when the logger manager starts */
+#define NGOLOG_LEVELS_ENV "NGOLOG_LEVELS"
+
+/*******************************************************************************
+   CLASS NgoLogConfig DECLARATION
+*******************************************************************************/
+/*!
+@class NgoLogConfig
+@brief class to set the levels of the loggers and of the categories of logs while running
+A configuration is a list of items name=LEVEL, separated by new lines, ';' or ','. A '#' starts
+a comment up to the end of the line. LEVEL is a name given by NgoLoggerManager::toString. name is:
+- '*' for all the loggers,
+- the name of a logger given by NgoLogger::setName,
+- the name of a category defined by NGOLOG_DEFINE_CATEGORY.
+The items are applied in order, so specific names follow '*':
+@code
+NGOLOG_LEVELS="*=ERROR;solver=DEBUG2;NgoLogKernel=DEBUG"
+@endcode
+A configuration replaces the previous one as a whole, under the lock of the logger manager: a
+logger or a category it no longer names gets back the level set by the code. A configuration
+which does not parse raises a NgoErrorInvalidArgument and changes nothing.
+
+The variable NGOLOG_LEVELS is applied when the logger manager starts. A file can also be loaded
+and watched, its modifications are applied at once on Linux (with inotify), or by calling reload
+elsewhere. The watch and the configuration end when the logger manager is shut down.
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoLogConfig
+{
+public:
+    /*! @brief applies a configuration */
+    /*! @param levels list of items name=LEVEL */
+    static void configure(const std::string & levels);
+    /*! @brief applies the configuration of a file, which becomes the file read by reload */
+    /*! @param filename path of the file */
+    static void load(const std::string & filename);
+    /*! @brief applies again the variable NGOLOG_LEVELS followed by the file loaded */
+    /*! @return false if there is neither variable nor file, the configuration is then kept */
+    static bool reload();
+    /*! @brief loads a file and applies its modifications as soon as they are written */
+    /*! On systems without inotify, the modifications are applied by reload. */
+    static void watch(const std::string & filename);
+    /*! @brief stops watching the file */
+    static void unwatch();
+    /*! @brief text of the configuration applied */
+    static std::string current();
+private:
+    friend class NgoLoggerManager;
+    friend class NgoLogger;
+    friend class NgoLogCategoryLevel;
+    /*! @brief applies the configuration to a logger being registered or renamed, the manager lock being held */
+    static void apply(NgoLogger * logger);
+    /*! @brief stops the watch and forgets the configuration, called when the manager stops */
+    static void reset();
+};
+
+#endif // _NgoLogConfig_h
@@ -0,0 +1,211 @@
+#ifndef _NgoLogIndex_h
+#define _NgoLogIndex_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLogIndex.h
+@date October 2026
+@brief File containing the sidecar index of the log files and the queries on it.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoLogging.h"
+
+/*******************************************************************************
+   INDEX LAYOUT
+*******************************************************************************/
+/*! @brief suffix appended to the name of a log file to get the name of its index */
+#define NGOLOG_INDEX_SUFFIX ".idx"
+
+/*! @brief magic string starting an index file */
+#define NGOLOG_INDEX_MAGIC "NGOLOGI1"
+
+/*! @brief size of the header of an index file: the magic string, the size of an entry and 1 */
+/*! The last 4 bytes are the integer 1 written by the logger, to detect an index written on a
+machine of another byte order. */
+#define NGOLOG_INDEX_HEADER_SIZE 16
+
+/*! @brief flag of an entry whose offset is the offset of the record in the text of a compressed block */
+#define NGOLOG_INDEX_IN_BLOCK 1
+
+/*!
+@brief entry of the index of a log file, one per record
+The index is an array of entries following the header, so it can be mapped and read in place.
+@ingroup grp_loggers
+*/
+struct NgoLogIndexEntry
+{
+    /*! @brief offset of the record in the file, or in the text of its block with NGOLOG_INDEX_IN_BLOCK */
+    uint64_t offset;
+    /*! @brief offset in the file of the compressed block holding the record, 0 for a text file */
+    uint64_t block;
+    /*! @brief time at which the record reached the logger, in microseconds since the epoch */
+    int64_t time;
+    /*! @brief size of the record */
+    uint32_t length;
+    /*! @brief value of @ref e_NgoErrorCode attached to the record, E_OK if none */
+    int16_t code;
+    /*! @brief TLogLevel of the record */
+    int8_t level;
+    /*! @brief NGOLOG_INDEX_IN_BLOCK or 0 */
+    uint8_t flags;
+};
+
+/*! @brief time of the clock used in the indexes, in microseconds since the epoch */
+/*! @ingroup grp_loggers */
+NGO_ERR_EXPORT int64_t NgoLogIndexTime();
+
+/*******************************************************************************
+   CLASS NgoLogIndexWriter DECLARATION
+*******************************************************************************/
+/*! @class NgoLogIndexWriter
+@brief class used by the file loggers to append the entries of their records to an index
+The entries are written by batches, and when the logger is flushed.
+@ingroup grp_loggers
+*/
+class NGO_ERR_EXPORT NgoLogIndexWriter
+{
+public:
+    /*! @brief constructor */
+    /*! @param filename path of the index */
+    /*! @param append if true, the entries are appended to an existing index */
+    NgoLogIndexWriter(std::string filename, bool append);
+    ~NgoLogIndexWriter();
+    /*! @brief adds the entry of a record */
+    void add(const NgoLogIndexEntry & entry)
+    {
+        pending_.push_back(entry);
+        if (pending_.size() == 1024)
+            write();
+    }
+    /*! @brief writes the pending entries and flushes the file */
+    void flush();
+private:
+    NgoLogIndexWriter(const NgoLogIndexWriter&);
+    NgoLogIndexWriter& operator =(const NgoLogIndexWriter&);
+    /*! @brief writes the pending entries */
+    void write();
+    FILE * file_;
+    std::vector<NgoLogIndexEntry> pending_;
+};
+
+/*******************************************************************************
+   QUERIES
+*******************************************************************************/
+/*!
+@brief selection of records by level, time range and error code
+@ingroup grp_loggers
+*/
+struct NGO_ERR_EXPORT NgoLogQuery
+{
+    NgoLogQuery();
+    /*! @brief records of this level or of a more severe level */
+    TLogLevel level;
+    /*! @brief first time selected, in microseconds since the epoch */
+    int64_t from;
+    /*! @brief first time no longer selected */
+    int64_t to;
+    /*! @brief code of the records selected, -1 for any code */
+    int code;
+    /*! @brief true if the query only selects on the level, the only criterion known without index */
+    bool levelOnly() const;
+    bool matches(const NgoLogIndexEntry & entry) const
+    {
+        return entry.level <= level && entry.time >= from && entry.time < to
+               && (code < 0 || entry.code == code);
+    }
+};
+
+/*******************************************************************************
+   CLASS NgoLogIndex DECLARATION
+*******************************************************************************/
+/*! @class NgoLogIndex
+@brief class to map the index of a log file and select its entries
+@ingroup grp_loggers
+*/
+class NGO_ERR_EXPORT NgoLogIndex
+{
+public:
+    /*! @brief constructor, mapping the index of a log file */
+    /*! @param logFilename path of the log file, not of its index */
+    /*! An index missing, of another byte order or of another version raises a NgoError. */
+    NgoLogIndex(std::string logFilename);
+    ~NgoLogIndex();
+    /*! @brief number of entries */
+    size_t size() const {return size_;};
+    const NgoLogIndexEntry & operator[](size_t i) const {return entries_[i];};
+    /*! @brief positions of the entries matching a query, in the order of the file */
+    /*! @param query selection
+    @param threads number of threads scanning the entries, 0 for the number of cores */
+    std::vector<size_t> select(const NgoLogQuery & query, unsigned threads=0) const;
+private:
+    NgoLogIndex(const NgoLogIndex&);
+    NgoLogIndex& operator =(const NgoLogIndex&);
+    const NgoLogIndexEntry * entries_;
+    size_t size_;
+    /*! @brief mapped file, or copy of the file where mapping is not available */
+    void * mapping_;
+    size_t mappedSize_;
+    std::vector<NgoLogIndexEntry> copy_;
+};
+
+/*! @brief selects the records of a log file without index, on their level only
+A text file is mapped and cut into as many parts as threads, scanned in parallel. The blocks of
+a file written by NgoLoggerCompressed are decompressed in parallel. The start of a record is
+recognised as a line starting with the name of a level followed by a tab.
+@param filename path of the log file
+@param query selection, which must be levelOnly: time and codes are only known from an index
+@param threads number of threads, 0 for the number of cores
+@return entries of the records selected, with no time nor code
+@ingroup grp_loggers */
+NGO_ERR_EXPORT std::vector<NgoLogIndexEntry> NgoLogScan(std::string filename, const NgoLogQuery & query, unsigned threads=0);
+
+/*******************************************************************************
+   CLASS NgoLogRecordReader DECLARATION
+*******************************************************************************/
+class NgoLogCompressedReader;
+
+/*! @class NgoLogRecordReader
+@brief class to read the records of a log file, text or compressed, from their index entries
+@ingroup grp_loggers
+*/
+class NGO_ERR_EXPORT NgoLogRecordReader
+{
+public:
+    NgoLogRecordReader(std::string filename);
+    ~NgoLogRecordReader();
+    /*! @brief reads the text of a record */
+    /*! @return reference valid until the next call */
+    const std::string & read(const NgoLogIndexEntry & entry);
+private:
+    NgoLogRecordReader(const NgoLogRecordReader&);
+    NgoLogRecordReader& operator =(const NgoLogRecordReader&);
+    FILE * file_;
+    NgoLogCompressedReader * compressed_;
+    /*! @brief offset and text of the last block decompressed */
+    uint64_t block_;
+    std::string blockText_;
+    std::string record_;
+};
+
+#endif // _NgoLogIndex_h
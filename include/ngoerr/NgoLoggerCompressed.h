@@ -0,0 +1,193 @@
+#ifndef _NgoLoggerCompressed_h
+#define _NgoLoggerCompressed_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLoggerCompressed.h
+@date October 2026
+@brief File containing a logger writing the logs to a file of independently compressed blocks.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ngoerr/NgoLogIndex.h"
+#include "ngoerr/NgoLogging.h"
+
+/*******************************************************************************
+   COMPRESSED FILE LAYOUT
+*******************************************************************************/
+/*! @brief magic string starting a compressed log file */
+#define NGOLOG_COMPRESSED_MAGIC "NGOLOGZ1"
+
+/*! @brief magic string starting each block */
+#define NGOLOG_BLOCK_MAGIC "NGZB"
+
+/*!
+@brief header of a block of a compressed log file, written in little endian
+A compressed log file is made of the 8 characters of NGOLOG_COMPRESSED_MAGIC followed by blocks.
+Each block is a header followed by storedSize bytes. When storedSize equals rawSize, the block
+is stored uncompressed, otherwise it is compressed with NgoLogCompress. A block holds whole
+records, so it can be decompressed and read independently of the other blocks.
+@ingroup grp_loggers
+*/
+struct NgoLogBlockHeader
+{
+    /*! @brief NGOLOG_BLOCK_MAGIC */
+    char magic[4];
+    /*! @brief size of the text of the block */
+    uint32_t rawSize;
+    /*! @brief size of the data following the header */
+    uint32_t storedSize;
+    /*! @brief FNV-1a hash of the text of the block */
+    uint32_t checksum;
+};
+
+/*! @brief size of a block header in the file */
+#define NGOLOG_BLOCK_HEADER_SIZE 16
+
+/*! @brief maximal size of the compression of n bytes */
+/*! @ingroup grp_loggers */
+NGO_ERR_EXPORT size_t NgoLogCompressBound(size_t n);
+
+/*! @brief compresses a buffer with a fast LZ77 codec, in the LZ4 block layout */
+/*! @param src buffer to compress */
+/*! @param n size of src */
+/*! @param dst output buffer */
+/*! @param capacity size of dst, at least NgoLogCompressBound(n) */
+/*! @return size of the compressed data, 0 if capacity is too small */
+/*! @ingroup grp_loggers */
+NGO_ERR_EXPORT size_t NgoLogCompress(const char * src, size_t n, char * dst, size_t capacity);
+
+/*! @brief decompresses a buffer compressed by NgoLogCompress */
+/*! @param src compressed data */
+/*! @param n size of src */
+/*! @param dst output buffer of rawSize bytes */
+/*! @param rawSize size of the decompressed data */
+/*! @return false if the data are corrupted or do not decompress to exactly rawSize bytes */
+/*! @ingroup grp_loggers */
+NGO_ERR_EXPORT bool NgoLogDecompress(const char * src, size_t n, char * dst, size_t rawSize);
+
+/*******************************************************************************
+   CLASS NgoLoggerCompressed DECLARATION
+*******************************************************************************/
+/*! @class NgoLoggerCompressed
+@brief class to log the output to a file of compressed blocks.
+The records are collected into blocks which are compressed and written by a background thread,
+so the logging threads only copy the records. When the background thread is behind by more than
+a few blocks, the logging threads wait for it. Use the tool ngolog_cat, or
+@ref NgoLogCompressedReader, to read the file.
+@ingroup grp_loggers_avl
+*/
+class NGO_ERR_EXPORT NgoLoggerCompressed : public NgoLogger
+{
+public:
+    /*! @brief constructor */
+    /*! @param filename path of the compressed file */
+    /*! @param blockSize size of the text collected before a block is compressed */
+    /*! @param reportingLevel reporting level */
+    /*! @param append if true, the blocks are appended to an existing compressed file */
+    /*! @param index if true, the records are indexed in the file filename + NGOLOG_INDEX_SUFFIX */
+    NgoLoggerCompressed(std::string filename,
+                        size_t blockSize=65536,
+                        TLogLevel reportingLevel=logDEBUG4,
+                        bool append=false,
+                        bool index=false);
+    ~NgoLoggerCompressed();
+    virtual void output(const TLogLevel level, std::string & log);
+    /*! @brief writes the current block, even if it is not full, and waits until the file is written */
+    virtual void flush();
+private:
+    NgoLoggerCompressed(const NgoLoggerCompressed&);
+    NgoLoggerCompressed& operator =(const NgoLoggerCompressed&);
+    /*! @brief text of a block and the index entries of its records */
+    struct Block
+    {
+        std::string text;
+        std::vector<NgoLogIndexEntry> entries;
+    };
+    /*! @brief hands the current block over to the background thread */
+    void submit();
+    /*! @brief loop of the background thread */
+    void run();
+    /*! @brief compresses and writes a block, in the background thread */
+    void writeBlock(Block & block);
+
+    FILE * file_;
+    size_t blockSize_;
+    /*! @brief block being collected */
+    Block current_;
+    /*! @brief index written by the background thread, 0L if the records are not indexed */
+    NgoLogIndexWriter * index_;
+    /*! @brief offset in the file of the next block written */
+    uint64_t fileOffset_;
+
+    /*! @brief lock of the queue shared with the background thread */
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable done_;
+    /*! @brief blocks waiting to be written */
+    std::deque<Block> queue_;
+    /*! @brief blocks already written, reused to collect the next ones */
+    std::vector<Block> free_;
+    /*! @brief true while the background thread writes a block */
+    bool writing_;
+    bool stop_;
+    /*! @brief compression buffer of the background thread */
+    std::vector<char> compressed_;
+    std::thread worker_;
+};
+
+/*******************************************************************************
+   CLASS NgoLogCompressedReader DECLARATION
+*******************************************************************************/
+/*! @class NgoLogCompressedReader
+@brief class to read back, block by block, a file written by @ref NgoLoggerCompressed
+@ingroup grp_loggers
+*/
+class NGO_ERR_EXPORT NgoLogCompressedReader
+{
+public:
+    /*! @brief constructor, opening the file and checking its magic string */
+    NgoLogCompressedReader(std::string filename);
+    ~NgoLogCompressedReader();
+    /*! @brief reads the next block */
+    /*! @param text receives the text of the block */
+    /*! @return false at the end of the file. A corrupted or truncated block raises a NgoError */
+    bool next(std::string & text);
+    /*! @brief moves to the block starting at an offset of the file, as given by the index */
+    void seek(unsigned long long offset);
+    /*! @brief number of bytes read from the file so far */
+    unsigned long long storedBytes() const {return storedBytes_;};
+private:
+    NgoLogCompressedReader(const NgoLogCompressedReader&);
+    NgoLogCompressedReader& operator =(const NgoLogCompressedReader&);
+    FILE * file_;
+    std::string filename_;
+    std::vector<char> stored_;
+    unsigned long long storedBytes_;
+};
+
+#endif // _NgoLoggerCompressed_h
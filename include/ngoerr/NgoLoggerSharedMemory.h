@@ -0,0 +1,168 @@
+#ifndef _NgoLoggerSharedMemory_h
+#define _NgoLoggerSharedMemory_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLoggerSharedMemory.h
+@date October 2026
+@brief File containing a logger writing into a shared memory ring, and the reader of this ring.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+#include "ngoerr/NgoLogging.h"
+
+/*******************************************************************************
+   SHARED MEMORY LAYOUT
+*******************************************************************************/
+/*! @brief version of the layout of the shared memory ring */
+#define NGOLOG_SHM_VERSION 1
+
+/*!
+@brief header at the beginning of the shared memory ring
+The ring is made of slotCount slots of slotSize bytes following the header.
+The record of sequence number n is written in the slot n % slotCount.
+@ingroup grp_loggers
+*/
+struct NgoLogShmHeader
+{
+    /*! @brief "NGOLOGSH" */
+    char magic[8];
+    /*! @brief NGOLOG_SHM_VERSION */
+    uint32_t version;
+    /*! @brief size of a slot in bytes, header of the slot included */
+    uint32_t slotSize;
+    /*! @brief number of slots */
+    uint64_t slotCount;
+    /*! @brief sequence number of the next record to be written */
+    std::atomic<uint64_t> nextSequence;
+};
+
+/*!
+@brief header of a slot, followed by the text of the record
+The stamp is 0 for an empty slot, odd while a record is written, and 2*(sequence+1) once the
+record of the given sequence number is complete. A reader copies the record and checks the stamp
+has not changed meanwhile, otherwise the record has been overwritten and is reported as lost.
+@ingroup grp_loggers
+*/
+struct NgoLogShmSlot
+{
+    /*! @brief stamp of the slot */
+    std::atomic<uint64_t> stamp;
+    /*! @brief level of the record */
+    uint32_t level;
+    /*! @brief length of the text. The high bit is set when the record has been truncated */
+    uint32_t length;
+};
+
+/*******************************************************************************
+   CLASS NgoLoggerSharedMemory DECLARATION
+*******************************************************************************/
+/*! @class NgoLoggerSharedMemory
+@brief class to log the output in a POSIX shared memory ring.
+Records are copied in the ring without any system call, and can be tailed, filtered or saved by
+another process (see the tool ngolog_shmtail). When the reader is too slow, the oldest records
+are overwritten: the reader detects it with the sequence numbers and reports the gap.
+Records longer than a slot are truncated.
+A ring created again with the same name is reset in place: the object only grows, so the readers
+attached keep a valid mapping, and they resynchronise on the new ring.
+@ingroup grp_loggers_avl
+*/
+class NGO_ERR_EXPORT NgoLoggerSharedMemory : public NgoLogger
+{
+public:
+    /*! @brief constructor */
+    /*! @param name name of the shared memory object, starting with '/' */
+    /*! @param slotCount number of records kept in the ring */
+    /*! @param slotSize size of a slot in bytes (multiple of 8), slot header included */
+    /*! @param reportingLevel reporting level */
+    /*! @param unlinkOnDestruction if true, the shared memory object is removed by the destructor,
+    otherwise it is kept to be read after the end of the process */
+    NgoLoggerSharedMemory(std::string name,
+                          unsigned slotCount=4096,
+                          unsigned slotSize=256,
+                          TLogLevel reportingLevel=logDEBUG4,
+                          bool unlinkOnDestruction=false);
+    ~NgoLoggerSharedMemory();
+    virtual void output(const TLogLevel level, std::string & log);
+    virtual void flush();
+private:
+    /*! @brief name of the shared memory object */
+    std::string name_;
+    /*! @brief mapped ring */
+    NgoLogShmHeader * header_;
+    /*! @brief size of the mapping */
+    size_t mappedSize_;
+    /*! @brief true if the object is removed on destruction */
+    bool unlink_;
+};
+
+/*******************************************************************************
+   CLASS NgoLogSharedMemoryReader DECLARATION
+*******************************************************************************/
+/*! @class NgoLogSharedMemoryReader
+@brief class to read the records of a ring written by @ref NgoLoggerSharedMemory from any process
+The slots are addressed with the geometry read when the ring was mapped. When a writer creates
+the ring again with another geometry, the reader maps it again and starts over with its first
+record.
+@ingroup grp_loggers
+*/
+class NGO_ERR_EXPORT NgoLogSharedMemoryReader
+{
+public:
+    /*! @brief a record read from the ring */
+    struct Record
+    {
+        /*! @brief sequence number of the record */
+        unsigned long long sequence;
+        /*! @brief number of records lost (overwritten) between the previous record read and this one */
+        unsigned long long lost;
+        /*! @brief level of the record */
+        TLogLevel level;
+        /*! @brief true if the text has been truncated by the writer */
+        bool truncated;
+        /*! @brief text of the record */
+        std::string text;
+    };
+
+    /*! @brief constructor, attaching the shared memory object read only */
+    /*! @param name name of the shared memory object */
+    /*! @param fromNow if true, only the records written after the attachment are read,
+    otherwise the reading starts with the oldest record still available */
+    NgoLogSharedMemoryReader(std::string name, bool fromNow=false);
+    ~NgoLogSharedMemoryReader();
+    /*! @brief reads the next record */
+    /*! @return false if no new record is available for now, raises a NgoError if the ring has
+    been created again with a layout which can not be mapped */
+    bool next(Record & record);
+private:
+    NgoLogSharedMemoryReader(const NgoLogSharedMemoryReader&);
+    NgoLogSharedMemoryReader& operator =(const NgoLogSharedMemoryReader&);
+    /*! @brief maps the object again once its geometry has changed */
+    void remap();
+    std::string name_;
+    const NgoLogShmHeader * header_;
+    size_t mappedSize_;
+    /*! @brief geometry of the ring mapped, used to address the slots */
+    uint64_t slotCount_;
+    uint32_t slotSize_;
+    /*! @brief sequence number of the next record to read */
+    unsigned long long expected_;
+};
+
+#endif // _NgoLoggerSharedMemory_h
@@ -25,6 +25,9 @@ error types that may happen during a calculation. This exceptions and error type
 */
 
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <stdio.h>
@@ -50,10 +53,46 @@ extern "C" {
 /*! @ingroup grp_log */
 enum TLogLevel {logERROR, logWARNING, logINFO, logDEBUG, logDEBUG1, logDEBUG2, logDEBUG3, logDEBUG4};
 
+/*! @enum TLogBackpressure : behaviour of a logger whose capacity is reached, see NgoLogger::setBackpressure */
+/*! @ingroup grp_log */
+enum TLogBackpressure {logBLOCK, logDROP_NEWEST, logDROP_OLDEST, logDROP_BELOW_LEVEL};
+
 /*! @brief function to create a log with a formatted string */
+/*! The message is formatted with vsnprintf directly into a record buffer owned by the calling
+thread and dispatched to the loggers, without going through a NgoLog stream. Only messages
+longer than the buffer capacity cause an allocation, the first time they occur. A disabled
+log is filtered by the lock free check of NGOLOG, before any formatting. */
+/*! @return 1, or -1 if level is not a TLogLevel or fmt can not be formatted */
 /*! @ingroup grp_log */
 NGO_ERR_EXPORT int NgoLogf(TLogLevel level, const char * fmt, ... );
 
+/*! @struct NgoLogEntry
+@brief a log record submitted by NgoLogWriteBatch
+@ingroup grp_log
+*/
+typedef struct NgoLogEntry
+{
+    /*! @brief level of the record */
+    TLogLevel level;
+    /*! @brief text of the record, without the level prefix nor the final new line */
+    const char * text;
+    /*! @brief number of characters of text, or a negative value if text is null terminated */
+    /*! Fortran callers pass len(text) as their strings are not null terminated */
+    int length;
+} NgoLogEntry;
+
+/*! @brief function to submit several logs in one call */
+/*! The logger manager lock is taken once for the whole batch. Each entry is prefixed with its
+level and terminated by a new line, as a log created by NGOLOG. Entries above the reporting
+level of the loggers are skipped, as by NGOLOG, before the lock is taken: it is not taken if no
+entry is left. The levels are checked first: if one of them is not a
+TLogLevel, nothing is dispatched. */
+/*! @param entries array of count records */
+/*! @param count number of records */
+/*! @return number of records dispatched to the loggers, or -1 if a level is not a TLogLevel */
+/*! @ingroup grp_log */
+NGO_ERR_EXPORT int NgoLogWriteBatch(const NgoLogEntry * entries, int count);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif // end of ifdef __cplusplus
@@ -67,6 +106,8 @@ NGO_ERR_EXPORT int NgoLogf(TLogLevel level, const char * fmt, ... );
 @brief class to create a log of certain level
 User can access the stream which is automatically redirected to the logger manager to dispatch it to all loggers
 It is usually used through the macro NGOLOG : NGOLOG(LogError) << "a log defining an error";
+The doubles are written in the scientific notation with 5 digits, as printf("%.5e"), by a facet
+formatting them with std::to_chars: the text does not depend on the global locale.
 @ingroup grp_log
 */
 class NGO_ERR_EXPORT NgoLog
@@ -80,6 +121,9 @@ public:
     virtual ~NgoLog();
     /*! @brief method to return the stream */
     std::ostringstream& get() {return os;};
+    /*! @brief method to attach the code of an error to the log, written in the log indexes */
+    /*! @param code value of @ref e_NgoErrorCode */
+    void setCode(int code) {code_ = code;};
 protected:
     /*! @brief stream */
     std::ostringstream os;
@@ -92,9 +136,49 @@ private:
     TLogLevel level_;
     /*! @brief unicity of the log content */
     bool unique_;
+    /*! @brief code of the error logged, E_OK for other logs */
+    int code_;
+};
+
+/*******************************************************************************
+   CLASS NgoLogArray DECLARATION
+*******************************************************************************/
+/*!
+@class NgoLogArray
+@brief manipulator writing an array of doubles to a stream, separated by a string
+@code
+NGOLOG(logDEBUG) << "x = " << NgoLogArray(x,n);
+@endcode
+In a NgoLog stream, the text is the one of a loop writing the values one by one: each value is
+formatted with std::to_chars into a local buffer, and the buffer is written at once. Other
+streams get the loop, unless they are set to the scientific notation without width nor flags,
+which is then written without their locale.
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoLogArray
+{
+public:
+    /*! @param values array of size values
+    @param separator string written between two values, which must outlive the manipulator */
+    NgoLogArray(const double * values, size_t size, const char * separator=" ")
+    :values_(values),size_(size),separator_(separator) {};
+    NgoLogArray(const std::vector<double> & values, const char * separator=" ")
+    :values_(values.empty() ? 0L : &values[0]),size_(values.size()),separator_(separator) {};
+private:
+    friend NGO_ERR_EXPORT std::ostream & operator <<(std::ostream & os, const NgoLogArray & array);
+    const double * values_;
+    size_t size_;
+    const char * separator_;
 };
 
+/*! @brief writes the values of the array to the stream */
+/*! @ingroup grp_log */
+NGO_ERR_EXPORT std::ostream & operator <<(std::ostream & os, const NgoLogArray & array);
+
 /*! this define can be modified to disable all logs of a certain levels on a given build */
+/*! It is only expanded by the macros, where the log is written, so that a translation unit can
+define it before its first include of this file, to strip the logs of this unit only. Defined after
+the include, it would redefine the default below. */
 #ifndef NGOLOG_MAX_LEVEL
 #define NGOLOG_MAX_LEVEL logDEBUG4
 #endif
@@ -111,15 +195,30 @@ private:
 @ingroup grp_loggers
 */
 
+/*! @brief queue and thread of a logger when the sink workers are enabled, defined by the manager */
+struct NgoLoggerWorker;
+/*! @brief thread reporting the repeats counted once their timeout has passed, defined by the manager */
+struct NgoLogRepeatTimer;
+
 /*
 @class NgoLogger
 @brief abstract class for all loggers.
 Loggers are used to stream the logs to a specific output (console, file, string,...)
+The method output is always called with the logger manager lock held, or by the worker of the
+logger, so a logger does not need to protect its own state against concurrent logs.
+A logger deriving directly from NgoLogger is registered by the base constructor, before its own
+constructor has run: it must not be created while other threads are logging. The loggers of the
+library register at the end of their constructor and unregister at the beginning of their destructor.
+With NgoLoggerManager::enableSinkWorkers, output and flush are called by the worker thread of the
+logger instead, one call at a time, and a logger has to unregister at the beginning of its
+destructor, as the worker may be running until then.
 @ingroup grp_loggers
 */
 class NgoLogger
 {
     friend class NgoLoggerManager;
+    friend class NgoLogConfig;
+    friend struct NgoLoggerWorker;
 public :
     /*! @constructor */
     /*! @brief : on construction, the logger registers itself to the logger manager */
@@ -127,7 +226,8 @@ public :
     NgoLogger(TLogLevel reportingLevel=logDEBUG4);
     /*! @brief destructor */
     /*! @brief on destruction, the logger unscribes itself to the logger manager */
-    ~NgoLogger();
+    /*! virtual as the manager deletes the loggers it owns through this class */
+    virtual ~NgoLogger();
     /*! @brief method to output a log
     level level of the log to output
     log string containing the log
@@ -135,11 +235,57 @@ public :
     virtual void output(const TLogLevel level, std::string & log)=0;
     /*! @brief method to flush the log */
     virtual void flush()=0;
-    /*! @brief method to return and access the reporting level */
-    TLogLevel& reportingLevel() {return reportingLevel_;};
+    /*! @brief method to return the reporting level */
+    /*! It is modified by setReportingLevel, which lets NGOLOG take it into account. */
+    TLogLevel reportingLevel() const {return reportingLevel_.load(std::memory_order_relaxed);};
+    /*! @brief method to modify the reporting level */
+    /*! It overrides the level given by NgoLogConfig until the configuration is applied again */
+    void setReportingLevel(TLogLevel reportingLevel);
+    /*! @brief name used to set the reporting level of the logger with NgoLogConfig */
+    const std::string & name() const {return name_;};
+    /*! @brief method to name the logger, the configuration for this name is applied at once */
+    void setName(const std::string & name);
+    /*! @brief method to bound the logs waiting to be output by the logger */
+    /*! The capacity bounds the queue of the logger when the sink workers are enabled, and the
+    buffer of a NgoLoggerBufferedString. When it is reached, a new log:
+    - logBLOCK: waits until the worker takes the queue, holding the lock of the manager, so the
+      logger must not log from its output. A buffered string has no reader to wait for, its
+      buffer grows,
+    - logDROP_NEWEST: is dropped,
+    - logDROP_OLDEST: replaces the oldest log waiting, which is dropped,
+    - logDROP_BELOW_LEVEL: is dropped if it is less severe than keepLevel, and kept beyond the
+      capacity otherwise, so an ERROR is always kept.
+    Once there is room again, the logger outputs a WARNING telling how many logs were dropped.
+    @param policy behaviour when the capacity is reached
+    @param capacity number of logs, 0 for no bound
+    @param keepLevel least severe level kept by logDROP_BELOW_LEVEL */
+    void setBackpressure(TLogBackpressure policy, size_t capacity, TLogLevel keepLevel=logWARNING);
+    /*! @brief number of logs dropped by the logger */
+    unsigned long long dropped() const {return dropped_.load(std::memory_order_relaxed);};
 protected:
-    /*! @brief reporting level */
-    TLogLevel reportingLevel_;
+    /*! @brief constructor for derived loggers which register themselves once fully constructed */
+    /*! @param reportingLevel log level of the logger */
+    /*! @param autoRegister if false, the derived class has to call registerLogger */
+    NgoLogger(TLogLevel reportingLevel, bool autoRegister);
+    /*! @brief method to register the logger to the logger manager */
+    void registerLogger();
+    /*! @brief method to unregister the logger from the logger manager. It can be called several times */
+    void unregisterLogger();
+    /*! @brief reporting level, atomic as a worker reads it in output while it is set */
+    std::atomic<TLogLevel> reportingLevel_;
+    /*! @brief backpressure policy, capacity and level kept, read while they are set */
+    std::atomic<TLogBackpressure> backpressure_;
+    std::atomic<size_t> capacity_;
+    std::atomic<TLogLevel> keepLevel_;
+    std::atomic<unsigned long long> dropped_;
+private:
+    std::string name_;
+    /*! @brief true while reportingLevel_ is set by NgoLogConfig */
+    bool configured_;
+    /*! @brief level to restore when the configuration no longer sets the level of the logger */
+    TLogLevel codeLevel_;
+    /*! @brief worker of the logger, null when its logs are output by the dispatching thread */
+    std::shared_ptr<NgoLoggerWorker> worker_;
 };
 
 /*! @class NgoLoggerFile
@@ -151,20 +297,27 @@ class NGO_ERR_EXPORT NgoLoggerFile: public NgoLogger
 public:
     /*! @brief constructor */
     /*! the FILE object can be a FILE, or stream like stderr or stdout */
-    /*! @param pFile pointer to FILE object to redirect the log */
+    /*! @param pFile pointer to FILE object to redirect the log. It is not closed by the logger */
     /*! @param reportingLevel reporting level */
     NgoLoggerFile(FILE* pFile,TLogLevel reportingLevel=logDEBUG4);
     ~NgoLoggerFile();
     virtual void output(const TLogLevel level, std::string & log);
     virtual void flush();
 protected:
+    /*! @brief constructor for derived loggers */
+    /*! @copydetails NgoLogger::NgoLogger(TLogLevel,bool) */
+    NgoLoggerFile(FILE* pFile,TLogLevel reportingLevel,bool autoRegister);
     /*! @brief pointer FILE object to redirect the log */
     FILE* pFile_;
 };
 
+class NgoLogIndexWriter;
+
 /*! class NgoLoggerFilename
 @param class to log the output to a file defined by a filename. 
 The file is closed at each flush and updated each time.
+It can write an index of the records, used by the tool ngolog_query to find records by level,
+time or error code without reading the file (see @ref NgoLogIndex).
 @ingroup grp_loggers_avl
 */
 class NGO_ERR_EXPORT NgoLoggerFilename : public NgoLoggerFile
@@ -174,13 +327,18 @@ public:
     /*! @param filename path of the file to redirect the output */
     /*! @param openingMode opening mode: 'w+' can be used to create a file or discard the content of an existing file, 'a' to append logs to an existing log */
     /*! @param reportingLevel reporting level */
-    NgoLoggerFilename(std::string filename,std::string openingMode="w+",TLogLevel reportingLevel=logDEBUG4);
+    /*! @param index if true, the records are indexed in the file filename + NGOLOG_INDEX_SUFFIX */
+    NgoLoggerFilename(std::string filename,std::string openingMode="w+",TLogLevel reportingLevel=logDEBUG4,bool index=false);
     ~NgoLoggerFilename();
     virtual void output(const TLogLevel level, std::string & log);
     virtual void flush();
 private:
     /*! @brief filename_ string to store the filename */
     std::string filename_;
+    /*! @brief index of the records, 0L if they are not indexed */
+    NgoLogIndexWriter * index_;
+    /*! @brief size of the file, offset of the next record */
+    unsigned long long offset_;
 };
 
 /*! class NgoLoggerBufferedString
@@ -198,12 +356,22 @@ public:
     virtual void output(const TLogLevel level, std::string & log);
     virtual void flush();
     /*! @brief method to retrieve the buffered message. Once retrieved the buffer is empty */
+    /*! the returned pointer belongs to the calling thread and is valid until its next call */
     const char * getBufferedMessage();
     /*! @brief method to know if buffer is empty or not*/
-    bool isBufferEmpty() {return buffer_.empty();}
+    bool isBufferEmpty() {std::lock_guard<std::mutex> lock(mutex_); return buffer_.empty();}
 private:
     /*! @brief string to hold the buffer */
     std::string buffer_;
+    /*! @brief lock of the buffer, written by the worker of the logger when sink workers are enabled */
+    std::mutex mutex_;
+    /*! @brief sizes of the logs in the buffer, from first_ */
+    std::vector<size_t> lengths_;
+    size_t first_;
+    /*! @brief offset of the first log kept in the buffer, the logs before are dropped */
+    size_t start_;
+    /*! @brief logs dropped since the buffer was last retrieved */
+    unsigned long long droppedPending_;
 };
 
 /*******************************************************************************
@@ -215,59 +383,242 @@ private:
 It deals with unique message (messages that should only appear once)
 It contains some methods that 
 It flushes the message in all registered loggers and remove current messages
+Logs can be emitted and loggers registered from several threads at once.
+
+The manager is a constant initialised static object: get() returns its address without testing nor
+allocating anything, and it can be used from constructors and destructors of other static objects.
+Its lifecycle has three phases:
+- UNINITIALISED: the first log or registration calls init implicitly.
+- RUNNING: init has registered the default buffered logger. Logs are dispatched to the loggers, or
+written to stderr while no logger is registered.
+- SHUT_DOWN: shutdown has flushed and deleted the loggers. Late logs of level logWARNING or lower
+are written to stderr, the others are dropped, and loggers created later are not registered
+(their owner has to delete them). init can be called again explicitly.
+
+shutdown and kill must not be called concurrently with other calls to the manager.
+
+With enableThreadBuffers, each thread appends its logs to its own buffer, stamped with a global
+sequence number, instead of dispatching them under the manager lock. The buffers are merged in
+sequence order into the loggers on flush, when a buffer is full, when a logger is registered or
+unregistered, and when a NgoLoggerBufferedString is read.
 @ingroup grp_logger
 */
 class NGO_ERR_EXPORT NgoLoggerManager
 {
     friend class NgoLog;
     friend class NgoLogger;
+    friend class NgoLoggerBufferedString;
+    friend class NgoCrashHandler;
+    friend class NgoLogConfig;
+public:
+    /*! @brief phases of the manager lifecycle */
+    enum Phase {UNINITIALISED, RUNNING, SHUT_DOWN};
+
     /* singleton base methods */
 private:
-    NgoLoggerManager();
-    ~NgoLoggerManager();
-    static NgoLoggerManager * instance_;
+    /*! @brief state created on first use: lock, loggers and unique logs. It is never freed, so
+    a thread still holding the manager during shutdown finds it empty rather than destroyed */
+    struct State;
+    constexpr NgoLoggerManager() : state_(0L), phase_(UNINITIALISED), bufferCapacity_(0) {};
+    static NgoLoggerManager instance_;
 
 public:
 	/*! @brief singleton get method */
-    static NgoLoggerManager * get(); 
+    static NgoLoggerManager * get() {return &instance_;};
+    /*! @brief method to start the manager: it registers the default buffered logger */
+    /*! It is called implicitly by the first use, calling it explicitly (at the load of the
+    library for instance) makes the startup predictable. It does nothing if already running. */
+    static void init();
+    /*! @brief method to stop the manager: the loggers are flushed and deleted */
+    /*! Logs emitted after shutdown follow the rules of the SHUT_DOWN phase. */
+    static void shutdown();
 	/*! @brief singleton kill method */
+    /*! shuts down the manager and returns it to the UNINITIALISED phase, so the next use
+    initialises it again */
     static void kill();
+    /*! @brief method to get the current phase of the manager */
+    static Phase phase() {return (Phase)instance_.phase_.load(std::memory_order_acquire);};
 
 public:
     /*! @brief method to flush all registered loggers */
+    /*! the logs emitted before the call and still in thread buffers are dispatched first */
     void flush();
+    /*! @brief method to make each thread append its logs to its own buffer */
+    /*! The logs of all threads reach the loggers in the order of their sequence number, whatever
+    thread dispatches them, and the logging threads no longer contend on the manager lock.
+    A logger then receives the logs when the buffers are merged, not when they are emitted. */
+    /*! @param capacity number of bytes of a thread buffer which triggers a merge */
+    void enableThreadBuffers(size_t capacity = 65536);
+    /*! @brief method to dispatch again each log when it is emitted. Pending logs are merged first */
+    void disableThreadBuffers();
+    /*! @brief method to give each logger its own queue and worker thread */
+    /*! The dispatch of a log only appends it to the queue of each logger, so a slow logger does
+    not delay the others. Each logger receives the logs in the order they are dispatched.
+    flush waits until every worker has output the logs dispatched before the call and flushed
+    its logger. The loggers registered later get a worker too. */
+    void enableSinkWorkers();
+    /*! @brief method to output the logs from the dispatching thread again, once the queues are empty */
+    /*! it must not be called while a logger logs from its output */
+    void disableSinkWorkers();
+    /*! @brief method to count the identical consecutive logs instead of dispatching them */
+    /*! A log identical to the previous one, at the same level and with the same code, is found
+    by its hash, confirmed by a compare, and counted. A single log at its level
+    @code
+WARNING	: last message repeated 999 times
+    @endcode
+    is dispatched when a different log arrives, when the first repeat counted is older than the
+    timeout, on flush and when the manager stops. Unlike unique logs, a log is only coalesced
+    with the one before it. */
+    /*! @param timeout seconds after which the repeats counted are reported */
+    void enableRepeatCoalescing(double timeout = 30.);
+    /*! @brief method to dispatch every log again, once the repeats counted are reported */
+    void disableRepeatCoalescing();
     /*! @brief method to retrieve a level as a string */
     static std::string toString(TLogLevel level);
     /*! @brief method to retrieve a log level index from its string identifier */
     static TLogLevel fromString(const std::string& level);
     /*! @brief method to retrieve the highest reporting level of all registered identifiers */
     TLogLevel reportingLevel();
+    /*! @brief returns false if a log of this level can not reach any logger */
+    /*! This is the check made by NGOLOG: it is inline and lock free, and does not need the
+    manager to be initialised. The loggers still filter the logs with their own reporting level. */
+    static bool isEnabled(TLogLevel level) {return level <= enabledLevel_.load(std::memory_order_relaxed);};
+    /*! @brief method to recompute the level used by isEnabled from the registered loggers */
+    void updateReportingLevel();
+    /*! @brief code of the error attached to the log being dispatched, E_OK if none */
+    /*! only meaningful inside NgoLogger::output, on the thread calling it */
+    static int recordCode();
     /*! @brief method to access the vector of registered pointers */
     std::vector<NgoLogger *> getLoggers();
 	/*! @brief get buffered logger */
 	NgoLoggerBufferedString * getBufferedLogger();
 private:
-    std::vector<NgoLogger *> loggers_;
-    std::vector<std::string> uniqueLogs_;
+    /*! @brief method to register a logger, called by NgoLogger constructor */
+    void registerLogger(NgoLogger * logger);
+    /*! @brief method to unregister a logger, called by NgoLogger destructor */
+    void unregisterLogger(NgoLogger * logger);
+    /*! @brief returns the state, creating it on first call */
+    State & state();
+    /*! @brief returns the state, initialising the manager if it is still UNINITIALISED */
+    State & started();
+    /*! @brief method to start the manager. An implicit start does nothing once shut down */
+    void start(bool implicit);
+    /*! @brief method to flush and delete the loggers, then enter the phase next */
+    void stop(Phase next);
+    /*! @brief method to compute the level used by isEnabled, without initialising the manager */
+    TLogLevel computeReportingLevel();
+    /*! @brief method to dispatch a log to the loggers, or count it if it repeats the previous one, the lock being held */
+    /*! crashRecorded is true for the logs of the thread buffers, given to the crash handler when appended */
+    void dispatch(State & s, TLogLevel level, std::string & log, int code = E_OK, bool crashRecorded = false);
+    /*! @brief method to output or queue a log for each logger, the lock being held */
+    void deliver(State & s, TLogLevel level, std::string & log, int code, bool crashRecorded = false);
+    /*! @brief method to dispatch the log reporting the repeats counted, if any, the lock being held */
+    void dispatchRepeats(State & s);
+    /*! @brief method to stop the coalescing, returning its timer to be stopped without the lock */
+    std::shared_ptr<NgoLogRepeatTimer> stopRepeatCoalescing(State & s);
+    /*! @brief method to append a log to the buffer of the calling thread */
+    void appendToThreadBuffer(State & s, TLogLevel level, const std::string & log, int code);
+    /*! @brief method to merge the thread buffers into the loggers in sequence order */
+    void drainThreadBuffers();
+    /*! @brief method to wait until the worker of a logger, if any, has output the logs dispatched to it */
+    void waitForWorker(NgoLogger * logger);
+    /*! @brief registered loggers, without initialising the manager. The lock must be held */
+    std::vector<NgoLogger *> & loggers();
+    /*! @brief lock protecting the loggers, the unique logs and the dispatch of logs */
+    /*! it is recursive as a logger may be created or destroyed while dispatching */
+    std::recursive_mutex & mutex();
+    std::atomic<State *> state_;
+    std::atomic<int> phase_;
+    /*! @brief capacity of the thread buffers, 0 if logs are dispatched when emitted */
+    std::atomic<size_t> bufferCapacity_;
+    /*! @brief highest reporting level of the loggers, read by isEnabled */
+    /*! it is the most verbose level while uninitialised, so the first log initialises the manager */
+    static std::atomic<int> enabledLevel_;
 protected:
     /*! @brief this method allows to dispatch a log which is supposed to be unique */
-    void addUniqueLog(TLogLevel level, std::string & msg);
+    void addUniqueLog(TLogLevel level, std::string & msg, int code = E_OK);
     /*! @brief this is the method to dispatch a log to all loggers */
-    void addLog(TLogLevel level, std::string & msg);
-	/*! @brief buffered logger */
-	static NgoLoggerBufferedString * buffered;
+    void addLog(TLogLevel level, std::string & msg, int code = E_OK);
+    friend int ::NgoLogf(TLogLevel level, const char * fmt, ... );
+    friend int ::NgoLogWriteBatch(const NgoLogEntry * entries, int count);
 };
 
 /*! @brief this is the macro to use to create logs easily
 The macro will make no overhead for logs above the specified symbol NGOLOG_MAX_LEVEL.
 This symbol is defined at compile time
-Another test is then made to compare it to all registered reporting levels.
+Another test is then made to compare it to all registered reporting levels. This test is inline and
+reads a single atomic, without locking nor calling into the library.
 */
 #define NGOLOG(level) \
-    if (level > NGOLOG_MAX_LEVEL) ;\
-    else if (level > NgoLoggerManager::get()->reportingLevel()) ; \
+    if ((level) > NGOLOG_MAX_LEVEL) ;\
+    else if (!NgoLoggerManager::isEnabled(level)) ; \
     else NgoLog(level).get()
 
+/*!
+@class NgoLogCategoryLevel
+@brief runtime level of a category of logs, set by name with NgoLogConfig
+It is created on the first log of the category and is logDEBUG4 unless configured, so that only
+the compile time ceiling applies.
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoLogCategoryLevel
+{
+public:
+    /*! @brief constructor, registering the category and applying its configured level */
+    NgoLogCategoryLevel(const char * name);
+    ~NgoLogCategoryLevel();
+    const char * name() const {return name_;};
+    /*! @brief returns false if the logs of this level are disabled for the category */
+    bool isEnabled(TLogLevel level) const {return level <= level_.load(std::memory_order_relaxed);};
+private:
+    friend class NgoLogConfig;
+    NgoLogCategoryLevel(const NgoLogCategoryLevel&);
+    NgoLogCategoryLevel& operator =(const NgoLogCategoryLevel&);
+    const char * name_;
+    std::atomic<int> level_;
+};
+
+/*! @brief macro to define a category of logs with its own compile time ceiling
+A category is a tag type. Logs written with NGOLOG_CAT for this category and a level above the
+ceiling are removed at compile time, whatever the reporting level of the loggers.
+Below the ceiling, the level of the category can be lowered at runtime with NgoLogConfig, using
+the name of the category.
+@code
+NGOLOG_DEFINE_CATEGORY(NgoLogKernel, logWARNING);
+NGOLOG_CAT(NgoLogKernel, logDEBUG) << "never compiled in";
+@endcode
+*/
+#define NGOLOG_DEFINE_CATEGORY(category, maxLevel) \
+    struct category \
+    { \
+        static constexpr TLogLevel ceiling = maxLevel; \
+        static const char * name() { return #category; } \
+        static NgoLogCategoryLevel & runtimeLevel() { static NgoLogCategoryLevel level(#category); return level; } \
+    }
+
+/*! @brief returns true if a log of the given level is compiled in for the category */
+/*! @param maxLevel ceiling of the build, passed by the macros rather than expanded here, as the
+template is shared by the translation units which may define NGOLOG_MAX_LEVEL differently
+@ingroup grp_log */
+template <class Category>
+inline constexpr bool NgoLogCategoryEnabled(TLogLevel level, TLogLevel maxLevel)
+{
+    return (level <= Category::ceiling) && (level <= maxLevel);
+}
+
+/*! @brief default category, which has no other ceiling than NGOLOG_MAX_LEVEL */
+NGOLOG_DEFINE_CATEGORY(NgoLogDefaultCategory, logDEBUG4);
+
+/*! @brief macro to create a log in a category defined with NGOLOG_DEFINE_CATEGORY
+For a constant level above the ceiling of the category, the condition is a constant expression
+and the whole statement, including the evaluation of the streamed values, is removed.
+Otherwise the runtime level of the category is tested, then the level of the loggers as by NGOLOG.
+*/
+#define NGOLOG_CAT(category, level) \
+    if (!NgoLogCategoryEnabled<category>(level, NGOLOG_MAX_LEVEL)) ;\
+    else if (!category::runtimeLevel().isEnabled(level)) ;\
+    else NGOLOG(level)
+
 /*! @brief method to log the content of an error @ref NgoError to a properly formatted log
 The content is adapted to the reporting level of loggers
 */
@@ -0,0 +1,172 @@
+#ifndef _NgoScopeTimer_h
+#define _NgoScopeTimer_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoScopeTimer.h
+@date October 2026
+@brief File containing the named timers, their latency histograms and the scoped timer.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoLogging.h"
+
+/*******************************************************************************
+   HISTOGRAM LAYOUT
+*******************************************************************************/
+/*! @brief number of bits of the sub-buckets of a histogram */
+/*! Each power of two is cut into 2^NGO_TIMER_SUB_BITS buckets, so a value is known within 1/32 */
+#define NGO_TIMER_SUB_BITS 5
+
+/*! @brief number of buckets of a histogram, covering all the 64 bits values */
+#define NGO_TIMER_BUCKETS ((64-NGO_TIMER_SUB_BITS+1) << NGO_TIMER_SUB_BITS)
+
+/*******************************************************************************
+   CLASS NgoTimerSummary DECLARATION
+*******************************************************************************/
+/*!
+@brief percentiles of the samples of a timer, in nanoseconds
+The percentiles are the upper bounds of their buckets, so they overestimate the samples by less
+than 1/32. The maximum is exact until the timer is reset.
+@ingroup grp_log
+*/
+struct NGO_ERR_EXPORT NgoTimerSummary
+{
+    NgoTimerSummary();
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+    /*! @brief mean of the samples */
+    double mean;
+    /*! @brief compact text "n=... p50=... p99=... p999=... max=..." with the durations in s, ms, us or ns */
+    std::string toString() const;
+};
+
+/*******************************************************************************
+   CLASS NgoTimer DECLARATION
+*******************************************************************************/
+/*!
+@class NgoTimer
+@brief class of a named timer, recording durations into latency histograms
+Each thread records into its own log-linear histogram, without lock nor atomic read-modify-write:
+a sample costs an index computation and a few relaxed stores. The histograms of the threads are
+merged when the timer is summarised.
+
+The timers are registered by name. They are reported in the logs by report, or periodically by
+reportEvery, one line per timer:
+@code
+INFO	: timer solver.flash : n=1000 p50=12.3us p99=45.1us p999=80.2us max=95.4us
+@endcode
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoTimer
+{
+public:
+    /*! @brief constructor, registering the timer */
+    /*! @param name name of the timer in the reports */
+    NgoTimer(const std::string & name);
+    ~NgoTimer();
+    const std::string & name() const {return name_;};
+    /*! @brief records a duration */
+    /*! @param nanoseconds duration */
+    void record(uint64_t nanoseconds);
+    /*! @brief percentiles of the durations recorded since the timer was created or reset */
+    NgoTimerSummary summary() const;
+    /*! @brief forgets the durations recorded so far */
+    void reset();
+
+    /*! @brief timer registered with this name, created and kept until exit if there is none */
+    static NgoTimer & get(const std::string & name);
+    /*! @brief logs the summary of every timer with samples */
+    /*! @param level level of the logs
+    @param reset if true, the timers are reset once reported */
+    static void report(TLogLevel level=logINFO, bool reset=false);
+    /*! @brief logs the summary of the timers periodically, from a thread */
+    /*! Each report covers the durations recorded since the previous one. The reports stop with
+    stopReporting, or when the logger manager is shut down.
+    @param seconds period
+    @param level level of the logs */
+    static void reportEvery(double seconds, TLogLevel level=logINFO);
+    /*! @brief stops the periodic reports */
+    static void stopReporting();
+private:
+    NgoTimer(const NgoTimer&);
+    NgoTimer& operator =(const NgoTimer&);
+    /*! @brief merges the histograms of the threads, the registry lock being held */
+    void merge(std::vector<uint64_t> & counts, uint64_t & sum, uint64_t & max) const;
+    std::string name_;
+    /*! @brief index of the timer in the registry and in the histograms of the threads */
+    size_t id_;
+    /*! @brief counts and sum at the last reset, subtracted from the merged histograms */
+    std::vector<uint64_t> baseline_;
+    uint64_t baselineSum_;
+};
+
+/*******************************************************************************
+   CLASS NgoScopeTimer DECLARATION
+*******************************************************************************/
+/*!
+@class NgoScopeTimer
+@brief class recording into a timer the time spent in a scope
+@code
+{
+    NgoScopeTimer timer(NgoTimer::get("solver.flash"));
+    ...
+}
+@endcode
+@ingroup grp_log
+*/
+class NgoScopeTimer
+{
+public:
+    NgoScopeTimer(NgoTimer & timer)
+    :timer_(timer),start_(std::chrono::steady_clock::now())
+    {
+    }
+    ~NgoScopeTimer()
+    {
+        timer_.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start_).count());
+    }
+private:
+    NgoScopeTimer(const NgoScopeTimer&);
+    NgoScopeTimer& operator =(const NgoScopeTimer&);
+    NgoTimer & timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define NGO_SCOPE_TIMER_CONCAT2(a,b) a##b
+#define NGO_SCOPE_TIMER_CONCAT(a,b) NGO_SCOPE_TIMER_CONCAT2(a,b)
+
+/*! @brief macro to time the rest of the scope with the timer of the given name
+The timer is looked up once, on the first pass.
+@code
+NGO_SCOPE_TIMER("solver.flash");
+@endcode
+*/
+#define NGO_SCOPE_TIMER(name) \
+    static NgoTimer & NGO_SCOPE_TIMER_CONCAT(ngoTimer_,__LINE__) = NgoTimer::get(name); \
+    NgoScopeTimer NGO_SCOPE_TIMER_CONCAT(ngoScopeTimer_,__LINE__)(NGO_SCOPE_TIMER_CONCAT(ngoTimer_,__LINE__))
+
+#endif // _NgoScopeTimer_h
@@ -0,0 +1,123 @@
+#ifndef _NgoTrace_h
+#define _NgoTrace_h
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoTrace.h
+@date October 2026
+@brief File containing the tracing spans, exported in the Chrome trace event format.
+ */
+
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <stddef.h>
+#include <string>
+
+#include "ngoerr/NgoError.h"
+
+/*! @brief depth of the span stack of a thread kept with the names: deeper spans are counted only */
+#define NGO_TRACE_MAX_DEPTH 64
+
+/*******************************************************************************
+   CLASS NgoTrace DECLARATION
+*******************************************************************************/
+/*!
+@class NgoTrace
+@brief class of the trace sessions, recording the spans of every thread
+Each thread keeps the stack of the spans it is in, whether a trace is recorded or not: a NgoError
+built inside spans takes their names as the outer part of its scope. The names are copied as
+pointers and joined with "->" only when the scope is read or the error rendered.
+
+Between start and stop, the beginning and the end of the spans are also recorded into a buffer
+of each thread, whose lock is only shared with the export. write exports them in the Chrome trace
+event format, to be opened by chrome://tracing or Perfetto.
+@ingroup grp_log
+*/
+class NGO_ERR_EXPORT NgoTrace
+{
+public:
+    /*! @brief starts a session, forgetting the events of the previous one */
+    /*! @param capacity number of events recorded per thread, the spans beginning beyond are dropped */
+    static void start(size_t capacity=1<<20);
+    /*! @brief stops recording: the spans already begun still record their end */
+    static void stop();
+    /*! @brief true between start and stop */
+    static bool recording();
+    /*! @brief number of spans dropped in the session, as their thread buffer was full */
+    static size_t dropped();
+    /*! @brief events of the session in the Chrome trace event format */
+    static std::string chromeJson();
+    /*! @brief writes chromeJson to a file */
+    /*! @param filename path of the file, raises a NgoError if it cannot be written */
+    static void write(const std::string & filename);
+
+    /*! @brief enters a span: pushes it on the stack of the thread and records its beginning */
+    /*! @param name name of the span, which must outlive the errors and the export (a literal)
+    @return session recording the span, 0 if it is not recorded */
+    static unsigned begin(const char * name);
+    /*! @brief leaves the span entered last, recording its end if its beginning was */
+    static void end(const char * name, unsigned session);
+    /*! @brief innermost spans of the stack of the thread */
+    /*! @param names receives at most max names, from the outermost to the innermost
+    @return depth of the stack, greater than max if the outermost spans were left out */
+    static unsigned spans(const char ** names, unsigned max);
+};
+
+/*******************************************************************************
+   CLASS NgoTraceSpan DECLARATION
+*******************************************************************************/
+/*!
+@class NgoTraceSpan
+@brief class of a span lasting until the end of the scope
+@code
+{
+    NgoTraceSpan span("solver.flash");
+    ...
+}
+@endcode
+@ingroup grp_log
+*/
+class NgoTraceSpan
+{
+public:
+    explicit NgoTraceSpan(const char * name)
+    :name_(name),session_(NgoTrace::begin(name))
+    {
+    }
+    ~NgoTraceSpan()
+    {
+        NgoTrace::end(name_,session_);
+    }
+private:
+    NgoTraceSpan(const NgoTraceSpan&);
+    NgoTraceSpan& operator =(const NgoTraceSpan&);
+    const char * name_;
+    unsigned session_;
+};
+
+#define NGO_TRACE_CONCAT2(a,b) a##b
+#define NGO_TRACE_CONCAT(a,b) NGO_TRACE_CONCAT2(a,b)
+
+/*! @brief macro to trace the rest of the scope as a span of the given literal name
+@code
+NGO_TRACE_SPAN("solver.flash");
+@endcode
+*/
+#define NGO_TRACE_SPAN(name) \
+    NgoTraceSpan NGO_TRACE_CONCAT(ngoTraceSpan_,__LINE__)(name)
+
+#endif // _NgoTrace_h
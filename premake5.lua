@@ -11,6 +11,16 @@ workspace "NgoErr"
     }
     
     -- PROTECTED REGION ID(NgoErr.premake.solution) ENABLED START
+    cppdialect "C++17"
+
+    newoption {
+        trigger     = "tsan",
+        description = "Build all projects with ThreadSanitizer (gcc/clang only)"
+    }
+    filter "options:tsan"
+        buildoptions { "-fsanitize=thread" }
+        linkoptions { "-fsanitize=thread" }
+    filter {}
 
     -- PROTECTED REGION END
 
@@ -21,12 +31,31 @@ project "NgoErr"
     defines {_exportSymbol}
     
     -- PROTECTED REGION ID(NgoErr.premake.sharedlib) ENABLED START
+    if not os.istarget("windows") then
+        links { "pthread", "rt" }
+    end
 
     -- PROTECTED REGION END
 
     FilterSharedLibBuildOptions("NgoErr")
 
 
+project "NgoErr_static"
+
+    PrefilterStaticLibBuildOptions("NgoErr_s")
+    removedefines {"NGO_ERR_USE_DYN"}
+
+    -- PROTECTED REGION ID(NgoErr.premake.staticlib) ENABLED START
+    -- lets the users link the whole logging path with their code and inline the disabled logs
+    filter "configurations:Release"
+        flags { "LinkTimeOptimization" }
+    filter {}
+
+    -- PROTECTED REGION END
+
+    FilterStaticLibBuildOptions("NgoErr_s")
+
+
 project "test_NgoErr"
 
     PrefilterTestBuildOptions("test_NgoErr")
@@ -37,3 +66,91 @@ project "test_NgoErr"
     -- PROTECTED REGION END
 
     FilterTestBuildOptions("test_NgoErr")
+
+
+project "bench_NgoErr"
+
+    PrefilterExeBuildOptions("bench_NgoErr")
+    files {"bench/**.cpp"}
+    links { "NgoErr"}
+
+    -- PROTECTED REGION ID(NgoErr.premake.bench) ENABLED START
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("bench_NgoErr")
+
+
+project "bench_NgoErr_static"
+
+    PrefilterExeBuildOptions("bench_NgoErr_static")
+    files {"bench/**.cpp"}
+    removedefines {"NGO_ERR_USE_DYN"}
+    links { "NgoErr_static"}
+    if not os.istarget("windows") then
+        links { "pthread", "rt" }
+    end
+
+    -- PROTECTED REGION ID(NgoErr.premake.benchstatic) ENABLED START
+    filter "configurations:Release"
+        flags { "LinkTimeOptimization" }
+    filter {}
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("bench_NgoErr_static")
+
+
+project "stress_NgoErr"
+
+    PrefilterExeBuildOptions("stress_NgoErr")
+    files {"stress/**.cpp"}
+    links { "NgoErr"}
+    if not os.istarget("windows") then
+        links { "pthread" }
+    end
+
+    -- PROTECTED REGION ID(NgoErr.premake.stress) ENABLED START
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("stress_NgoErr")
+
+
+project "ngolog_shmtail"
+
+    PrefilterExeBuildOptions("ngolog_shmtail")
+    files {"tools/ngolog_shmtail.cpp"}
+    links { "NgoErr"}
+
+    -- PROTECTED REGION ID(NgoErr.premake.shmtail) ENABLED START
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("ngolog_shmtail")
+
+
+project "ngolog_cat"
+
+    PrefilterExeBuildOptions("ngolog_cat")
+    files {"tools/ngolog_cat.cpp"}
+    links { "NgoErr"}
+
+    -- PROTECTED REGION ID(NgoErr.premake.cat) ENABLED START
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("ngolog_cat")
+
+
+project "ngolog_query"
+
+    PrefilterExeBuildOptions("ngolog_query")
+    files {"tools/ngolog_query.cpp"}
+    links { "NgoErr"}
+
+    -- PROTECTED REGION ID(NgoErr.premake.query) ENABLED START
+
+    -- PROTECTED REGION END
+
+    FilterExeBuildOptions("ngolog_query")
@@ -0,0 +1,254 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoCrashHandler.cpp
+@date October 2026
+@brief File containing the emergency flush of the last logs on a fatal signal
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <atomic>
+#include <mutex>
+#include <signal.h>
+#include <string.h>
+#ifdef _WIN32
+   #include <io.h>
+#else
+   #include <unistd.h>
+#endif
+
+#include "ngoerr/NgoCrashHandler.h"
+#include "ngoerr/NgoLogging.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+#ifdef _WIN32
+   typedef void (*NgoSignalDisposition)(int);
+   #define NGO_WRITE(fd,buf,len) _write(fd,buf,(unsigned)(len))
+#else
+   typedef struct sigaction NgoSignalDisposition;
+   #define NGO_WRITE(fd,buf,len) write(fd,buf,len)
+#endif
+
+/*! @brief maximal number of handled signals */
+#define NGO_CRASH_MAX_SIGNALS 16
+
+/*******************************************************************************
+   GLOBAL VARIABLES
+*******************************************************************************/
+namespace
+{
+/*! @brief ring of the last logged bytes, with the file descriptor where it is written on a crash */
+struct NgoCrashRing
+{
+    NgoCrashRing(int descriptor, size_t length)
+    :data(new char[length]),size(length),fd(descriptor),written(0),retired(0L) {};
+    char * data;
+    size_t size;
+    int fd;
+    /*! @brief total number of bytes written in the ring */
+    std::atomic<unsigned long long> written;
+    /*! @brief ring uninstalled before this one */
+    NgoCrashRing * retired;
+};
+
+/*! @brief installed ring, published with its size so that record needs no lock */
+std::atomic<NgoCrashRing *> ring_(0L);
+/*! @brief rings uninstalled, never freed as a thread may still be recording into them */
+NgoCrashRing * retired_ = 0L;
+/*! @brief set once a crash is being handled, to write the ring only once */
+volatile sig_atomic_t crashing_ = 0;
+
+int signals_[NGO_CRASH_MAX_SIGNALS];
+NgoSignalDisposition previous_[NGO_CRASH_MAX_SIGNALS];
+int nSignals_ = 0;
+
+#ifndef _WIN32
+/*! @brief alternate stack, to be able to handle a stack overflow of the installing thread */
+char * altStack_ = 0L;
+#endif
+
+/*! @brief writes a buffer completely, retrying on partial writes */
+void writeAll(int fd, const char * buffer, size_t length)
+{
+    while (length > 0)
+    {
+        long n = (long)NGO_WRITE(fd,buffer,length);
+        if (n <= 0)
+            return;
+        buffer += n;
+        length -= (size_t)n;
+    }
+}
+
+/*! @brief writes a positive number without using stdio */
+void writeNumber(int fd, int value)
+{
+    char digits[16];
+    int n = sizeof(digits);
+    do
+    {
+        digits[--n] = (char)('0' + value%10);
+        value /= 10;
+    } while (value && n);
+    writeAll(fd,digits+n,sizeof(digits)-n);
+}
+
+void restore(int sig)
+{
+    for (int i=0;i<nSignals_;i++)
+    {
+        if (signals_[i] != sig)
+            continue;
+#ifdef _WIN32
+        signal(sig,previous_[i]);
+#else
+        sigaction(sig,&previous_[i],0L);
+#endif
+    }
+}
+
+void crashHandler(int sig)
+{
+    const NgoCrashRing * ring = ring_.load(std::memory_order_acquire);
+    if (!crashing_ && ring && ring->fd >= 0)
+    {
+        crashing_ = 1;
+        static const char header[] = "\n*** NgoErr emergency flush of the last logs on signal ";
+        writeAll(ring->fd,header,sizeof(header)-1);
+        writeNumber(ring->fd,sig);
+        writeAll(ring->fd," ***\n",5);
+        NgoCrashHandler::emergencyFlush();
+    }
+    restore(sig);
+    raise(sig);
+}
+
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoCrashHandler DEFINITION
+*******************************************************************************/
+void NgoCrashHandler::install(int fd, size_t ringSize, const int * signals, int nSignals)
+{
+    static const int defaultSignals[] = {
+        SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#ifndef _WIN32
+        SIGBUS,
+#endif
+    };
+    if (!signals)
+    {
+        signals = defaultSignals;
+        nSignals = sizeof(defaultSignals)/sizeof(defaultSignals[0]);
+    }
+    if (nSignals > NGO_CRASH_MAX_SIGNALS)
+        throw NgoErrorInvalidArgument(4,"Too many signals to handle","NgoCrashHandler::install");
+    if (ringSize == 0)
+        throw NgoErrorInvalidArgument(2,"The ring size must be positive","NgoCrashHandler::install");
+
+    uninstall();
+    {
+        std::lock_guard<std::recursive_mutex> lock(NgoLoggerManager::get()->mutex());
+        crashing_ = 0;
+        ring_.store(new NgoCrashRing(fd,ringSize),std::memory_order_release);
+    }
+
+#ifndef _WIN32
+    if (!altStack_)
+    {
+        altStack_ = new char[SIGSTKSZ*4];
+        stack_t stack;
+        memset(&stack,0,sizeof(stack));
+        stack.ss_sp = altStack_;
+        stack.ss_size = SIGSTKSZ*4;
+        sigaltstack(&stack,0L);
+    }
+#endif
+
+    nSignals_ = nSignals;
+    for (int i=0;i<nSignals;i++)
+    {
+        signals_[i] = signals[i];
+#ifdef _WIN32
+        previous_[i] = signal(signals[i],crashHandler);
+#else
+        struct sigaction action;
+        memset(&action,0,sizeof(action));
+        action.sa_handler = crashHandler;
+        action.sa_flags = SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        sigaction(signals[i],&action,&previous_[i]);
+#endif
+    }
+}
+
+void NgoCrashHandler::uninstall()
+{
+    for (int i=nSignals_-1;i>=0;i--)
+        restore(signals_[i]);
+    nSignals_ = 0;
+
+    std::lock_guard<std::recursive_mutex> lock(NgoLoggerManager::get()->mutex());
+    NgoCrashRing * ring = ring_.exchange(0L,std::memory_order_acq_rel);
+    if (ring)
+    {
+        ring->retired = retired_;
+        retired_ = ring;
+    }
+    // the alternate stack is kept: another handler may still be running on it
+}
+
+bool NgoCrashHandler::isInstalled()
+{
+    return ring_.load(std::memory_order_acquire) != 0L;
+}
+
+void NgoCrashHandler::emergencyFlush()
+{
+    const NgoCrashRing * ring = ring_.load(std::memory_order_acquire);
+    if (!ring || ring->fd < 0)
+        return;
+    unsigned long long written = ring->written.load(std::memory_order_acquire);
+    if (written <= ring->size)
+    {
+        writeAll(ring->fd,ring->data,(size_t)written);
+        return;
+    }
+    size_t start = (size_t)(written % ring->size);
+    writeAll(ring->fd,ring->data+start,ring->size-start);
+    writeAll(ring->fd,ring->data,start);
+}
+
+void NgoCrashHandler::record(const char * log, size_t length)
+{
+    NgoCrashRing * ring = ring_.load(std::memory_order_acquire);
+    if (!ring)
+        return;
+    if (length > ring->size)
+    {
+        log += length-ring->size;
+        length = ring->size;
+    }
+    unsigned long long written = ring->written.fetch_add(length,std::memory_order_acq_rel);
+    size_t start = (size_t)(written % ring->size);
+    size_t first = ring->size-start < length ? ring->size-start : length;
+    memcpy(ring->data+start,log,first);
+    memcpy(ring->data,log+first,length-first);
+}
@@ -29,10 +29,12 @@
 /*******************************************************************************
    INCLUDES
 *******************************************************************************/
+#include <charconv>
 #include <iostream>
 #include <string>
 
 #include "ngoerr/NgoError.h"
+#include "ngoerr/NgoTrace.h"
 /*******************************************************************************
    DEFINES / TYPDEFS / ENUMS
 *******************************************************************************/
@@ -40,14 +42,33 @@
 /*******************************************************************************
    GLOBAL VARIABLES
 *******************************************************************************/
+namespace
+{
+   /*! @brief Append a double as the default ostream formatting would (%g, 6 digits) */
+   void appendNumber(std::string & out, double value)
+   {
+      char buffer[32];
+      std::to_chars_result res = std::to_chars(buffer, buffer+sizeof(buffer), value, std::chars_format::general, 6);
+      out.append(buffer, res.ptr);
+   }
+
+   void appendNumber(std::string & out, int value)
+   {
+      char buffer[16];
+      std::to_chars_result res = std::to_chars(buffer, buffer+sizeof(buffer), value);
+      out.append(buffer, res.ptr);
+   }
+}
 
 /*******************************************************************************
    CLASS NgoError DEFINITION
 *******************************************************************************/
 
 NgoError::NgoError(std::string desc,std::string scope,std::string ifc,std::string oper)
-             :description_(desc), scope_(scope), interfaceName_(ifc), operation_(oper)
+             :code_(E_UNKNOWN), description_(desc), scope_(scope), interfaceName_(ifc), operation_(oper)
 {
+   // pointers to the names of the spans only: they are joined when the scope is read
+   spanDepth_ = NgoTrace::spans(spans_,NGO_ERR_MAX_SPANS);
 };
 
 void NgoError::addScopeError(std::string scope)
@@ -55,6 +76,7 @@ void NgoError::addScopeError(std::string scope)
    std::ostringstream oss;
    oss << scope << "->" << (*this).scope_;
    (*this).scope_ = oss.str();
+   text_.clear();
 };
 
 void NgoError::addDescription(std::string desc)
@@ -62,37 +84,107 @@ void NgoError::addDescription(std::string desc)
    std::ostringstream oss;
    oss << (*this).description_<< std::endl << desc;
    (*this).description_ = oss.str();
+   text_.clear();
 };
 
+std::string NgoError::getScope() const
+{
+   if (!spanDepth_)
+      return scope_;
+   std::string scope;
+   appendScope(scope);
+   return scope;
+}
+
+void NgoError::appendScope(std::string & out) const
+{
+   const unsigned n = spanDepth_ < NGO_ERR_MAX_SPANS ? spanDepth_ : NGO_ERR_MAX_SPANS;
+   if (spanDepth_ > n)
+      out += "...->";
+   for (unsigned i=0;i<n;i++)
+   {
+      if (i)
+         out += "->";
+      out += spans_[i];
+   }
+   if (n && !scope_.empty())
+      out += "->";
+   out += scope_;
+}
+
 void NgoError::print(
 std::ostream& os
 )
 const
 {
-   std::string line;
-   for (unsigned i=name_.length()+2;i--;)
-      line += "*";
-   os  << name_ << " :\n" << line;
-   line.clear();
-   if (!scope_.empty())
+   os << what();
+}
+
+const char * NgoError::what() const noexcept
+{
+   if (text_.empty())
+   {
+      try
+      {
+         render(text_);
+      }
+      catch (...)
+      {
+         // out of memory while rendering: fall back on the short name
+         text_.clear();
+         return name_.c_str();
+      }
+   }
+   return text_.c_str();
+}
+
+std::exception_ptr NgoError::exceptionPtr()
+{
+   // std::make_exception_ptr copies its argument: the error is moved by throwing it
+   // rendered first: the cache moves with the error, and is not filled by the threads sharing it
+   what();
+   std::exception_ptr ret;
+   try
+   {
+      rethrow();
+   }
+   catch (...)
+   {
+      ret = std::current_exception();
+   }
+   return ret;
+}
+
+void NgoError::render(
+std::string & out
+)
+const
+{
+   // one allocation for the common case: fixed labels plus the fields, room left for derived classes
+   out.reserve(out.size() + 2*name_.length() + scope_.length() + interfaceName_.length()
+                + operation_.length() + description_.length() + 160);
+   out += name_;
+   out += " :\n";
+   out.append(name_.length()+2, '*');
+   if (spanDepth_ || !scope_.empty())
    {
-      os << "\nScope : "
-           << scope_;
+      out += "\nScope : ";
+      appendScope(out);
    }
    if (!interfaceName_.empty())
    {
-      os << "\nInterface : "
-           << interfaceName_;
+      out += "\nInterface : ";
+      out += interfaceName_;
    }
    if (!operation_.empty())
    {
-      os << "\nOperation : "
-           << operation_;
+      out += "\nOperation : ";
+      out += operation_;
    }
    if (!description_.empty())
    {
-      os << "\nDescription :\n"
-           << description_;
+      out += "\nDescription :\n";
+      out += description_;
    }
 }
 
@@ -121,6 +213,7 @@ std::ostream& os
 )
 const
 {
+   // the numbers take the format of the stream, as the scientific notation of a NgoLog
    os << "\tA value ";
    if (type_ != "")
    {
@@ -129,6 +222,26 @@ const
    os << "(= " << value_ << ") is out of bounds [" << lower_bound_ << "," << upper_bound_ << "]\n";
 }
 
+void NgoErrorBoundaries::renderBoundaries(
+std::string & out
+)
+const
+{
+   out += "\tA value ";
+   if (type_ != "")
+   {
+      out += "of type ";
+      out += type_;
+   }
+   out += "(= ";
+   appendNumber(out, value_);
+   out += ") is out of bounds [";
+   appendNumber(out, lower_bound_);
+   out += ",";
+   appendNumber(out, upper_bound_);
+   out += "]\n";
+}
+
 /*******************************************************************************
    CLASS NgoErrorData INLINE FUNCTIONS
 *******************************************************************************/
@@ -171,15 +284,17 @@ NgoErrorBadArgument::NgoErrorBadArgument(int position
    name_ = "Bad Argument";
 };
 
-void NgoErrorBadArgument::print(
-std::ostream& os
+void NgoErrorBadArgument::render(
+std::string & out
 )
 const
 {
-   NgoError::print(os);
+   NgoError::render(out);
    if (position_)
    {
-      os << "\tArgument with position " << position_ << " is not correct.\n";
+      out += "\tArgument with position ";
+      appendNumber(out, position_);
+      out += " is not correct.\n";
    }
 }
 
@@ -232,10 +347,22 @@ std::ostream& os
 )
 const
 {
-   NgoErrorBadArgument::print(os);
+   // the cached text is only for what(): the bounds are written with the format of the stream
+   std::string text;
+   NgoErrorBadArgument::render(text);
+   os << text;
    NgoErrorBoundaries::print(os);
 }
 
+void NgoErrorOutOfBounds::render(
+std::string & out
+)
+const
+{
+   NgoErrorBadArgument::render(out);
+   renderBoundaries(out);
+}
+
 /*******************************************************************************
    CLASS NgoErrorSolving INLINE FUNCTIONS
 *******************************************************************************/
@@ -0,0 +1,417 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoErrorChecks.cpp
+@date October 2026
+@brief File containing the vectorized checks of arrays of values
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <sstream>
+#include <string.h>
+
+#include "ngoerr/NgoErrorChecks.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+// the kernels are compiled for every instruction set, and chosen at run time
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+   #define NGO_CHECKS_X86
+   #define NGO_TARGET_SSE2 __attribute__((target("sse2")))
+   #define NGO_TARGET_AVX __attribute__((target("avx")))
+   #include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+   #define NGO_CHECKS_X86
+   #define NGO_TARGET_SSE2
+   #define NGO_TARGET_AVX
+   #include <immintrin.h>
+   #include <intrin.h>
+#endif
+
+namespace
+{
+/*! @brief kernel returning the index of the first value out of bounds at or after start, or n */
+/*! scalar bounds are used when lower is null */
+typedef size_t (*BoundsKernel)(const double * v, size_t n, const double * lower, const double * upper,
+                               double lo, double hi, size_t start);
+
+inline bool inBounds(double v, double lo, double hi)
+{
+    return (v >= lo) && (v <= hi);
+}
+
+size_t firstOutOfBoundsScalar(const double * v, size_t n, const double * lower, const double * upper,
+                              double lo, double hi, size_t i)
+{
+    if (!lower)
+    {
+        for (;i<n;i++)
+            if (!inBounds(v[i],lo,hi))
+                return i;
+        return n;
+    }
+    for (;i<n;i++)
+        if (!inBounds(v[i],lower[i],upper[i]))
+            return i;
+    return n;
+}
+
+/*! @brief kernel returning the index of the first non finite value at or after start, or n */
+typedef size_t (*NonFiniteKernel)(const double * v, size_t n, size_t start);
+
+inline bool isNonFinite(double v)
+{
+    // infinities and NaN have all the bits of the exponent set
+    unsigned long long bits;
+    memcpy(&bits,&v,sizeof(bits));
+    return (bits & 0x7FF0000000000000ULL) == 0x7FF0000000000000ULL;
+}
+
+size_t firstNonFiniteScalar(const double * v, size_t n, size_t i)
+{
+    for (;i<n;i++)
+        if (isNonFinite(v[i]))
+            return i;
+    return n;
+}
+
+#ifdef NGO_CHECKS_X86
+NGO_TARGET_SSE2 size_t firstNonFiniteSse2(const double * v, size_t n, size_t i)
+{
+    // v-v is 0 for finite values and NaN otherwise
+    for (;i+8<=n;i+=8)
+    {
+        __m128d a = _mm_loadu_pd(v+i);
+        __m128d b = _mm_loadu_pd(v+i+2);
+        __m128d c = _mm_loadu_pd(v+i+4);
+        __m128d d = _mm_loadu_pd(v+i+6);
+        __m128d zero = _mm_add_pd(_mm_add_pd(_mm_sub_pd(a,a),_mm_sub_pd(b,b)),
+                                  _mm_add_pd(_mm_sub_pd(c,c),_mm_sub_pd(d,d)));
+        if (_mm_movemask_pd(_mm_cmpunord_pd(zero,zero)))
+            break;
+    }
+    return firstNonFiniteScalar(v,n,i);
+}
+
+NGO_TARGET_AVX size_t firstNonFiniteAvx(const double * v, size_t n, size_t i)
+{
+    for (;i+16<=n;i+=16)
+    {
+        __m256d a = _mm256_loadu_pd(v+i);
+        __m256d b = _mm256_loadu_pd(v+i+4);
+        __m256d c = _mm256_loadu_pd(v+i+8);
+        __m256d d = _mm256_loadu_pd(v+i+12);
+        __m256d zero = _mm256_add_pd(_mm256_add_pd(_mm256_sub_pd(a,a),_mm256_sub_pd(b,b)),
+                                     _mm256_add_pd(_mm256_sub_pd(c,c),_mm256_sub_pd(d,d)));
+        if (_mm256_movemask_pd(_mm256_cmp_pd(zero,zero,_CMP_UNORD_Q)))
+            break;
+    }
+    return firstNonFiniteScalar(v,n,i);
+}
+
+NGO_TARGET_SSE2 inline __m128d inBounds2(__m128d v, __m128d lo, __m128d hi)
+{
+    // ordered comparisons: a NaN value is out of bounds
+    return _mm_and_pd(_mm_cmpge_pd(v,lo),_mm_cmple_pd(v,hi));
+}
+
+NGO_TARGET_SSE2 size_t firstOutOfBoundsSse2(const double * v, size_t n, const double * lower, const double * upper,
+                                            double lo, double hi, size_t i)
+{
+    if (!lower)
+    {
+        const __m128d l = _mm_set1_pd(lo);
+        const __m128d h = _mm_set1_pd(hi);
+        // blocks of 8 values to locate the failure, then pairs to find it
+        for (;i+8<=n;i+=8)
+        {
+            __m128d ok = _mm_and_pd(_mm_and_pd(inBounds2(_mm_loadu_pd(v+i),l,h),inBounds2(_mm_loadu_pd(v+i+2),l,h)),
+                                    _mm_and_pd(inBounds2(_mm_loadu_pd(v+i+4),l,h),inBounds2(_mm_loadu_pd(v+i+6),l,h)));
+            if (_mm_movemask_pd(ok) != 0x3)
+                break;
+        }
+        for (;i+2<=n;i+=2)
+        {
+            int mask = _mm_movemask_pd(inBounds2(_mm_loadu_pd(v+i),l,h));
+            if (mask != 0x3)
+                return (mask & 1) ? i+1 : i;
+        }
+    }
+    else
+    {
+        for (;i+2<=n;i+=2)
+        {
+            int mask = _mm_movemask_pd(inBounds2(_mm_loadu_pd(v+i),_mm_loadu_pd(lower+i),_mm_loadu_pd(upper+i)));
+            if (mask != 0x3)
+                return (mask & 1) ? i+1 : i;
+        }
+    }
+    return firstOutOfBoundsScalar(v,n,lower,upper,lo,hi,i);
+}
+
+NGO_TARGET_AVX inline __m256d inBounds4(__m256d v, __m256d lo, __m256d hi)
+{
+    return _mm256_and_pd(_mm256_cmp_pd(v,lo,_CMP_GE_OQ),_mm256_cmp_pd(v,hi,_CMP_LE_OQ));
+}
+
+NGO_TARGET_AVX inline size_t firstClear4(int mask)
+{
+    for (size_t k=0;k<4;k++)
+        if (!(mask & (1<<k)))
+            return k;
+    return 4;
+}
+
+NGO_TARGET_AVX size_t firstOutOfBoundsAvx(const double * v, size_t n, const double * lower, const double * upper,
+                                          double lo, double hi, size_t i)
+{
+    if (!lower)
+    {
+        const __m256d l = _mm256_set1_pd(lo);
+        const __m256d h = _mm256_set1_pd(hi);
+        // blocks of 16 values to locate the failure, then quads to find it
+        for (;i+16<=n;i+=16)
+        {
+            __m256d ok = _mm256_and_pd(_mm256_and_pd(inBounds4(_mm256_loadu_pd(v+i),l,h),inBounds4(_mm256_loadu_pd(v+i+4),l,h)),
+                                       _mm256_and_pd(inBounds4(_mm256_loadu_pd(v+i+8),l,h),inBounds4(_mm256_loadu_pd(v+i+12),l,h)));
+            if (_mm256_movemask_pd(ok) != 0xF)
+                break;
+        }
+        for (;i+4<=n;i+=4)
+        {
+            int mask = _mm256_movemask_pd(inBounds4(_mm256_loadu_pd(v+i),l,h));
+            if (mask != 0xF)
+                return i+firstClear4(mask);
+        }
+    }
+    else
+    {
+        for (;i+8<=n;i+=8)
+        {
+            __m256d ok = _mm256_and_pd(inBounds4(_mm256_loadu_pd(v+i),_mm256_loadu_pd(lower+i),_mm256_loadu_pd(upper+i)),
+                                       inBounds4(_mm256_loadu_pd(v+i+4),_mm256_loadu_pd(lower+i+4),_mm256_loadu_pd(upper+i+4)));
+            if (_mm256_movemask_pd(ok) != 0xF)
+                break;
+        }
+        for (;i+4<=n;i+=4)
+        {
+            int mask = _mm256_movemask_pd(inBounds4(_mm256_loadu_pd(v+i),_mm256_loadu_pd(lower+i),_mm256_loadu_pd(upper+i)));
+            if (mask != 0xF)
+                return i+firstClear4(mask);
+        }
+    }
+    return firstOutOfBoundsScalar(v,n,lower,upper,lo,hi,i);
+}
+
+bool hasAvx()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,1);
+    // AVX and OSXSAVE, and the OS saves the YMM registers
+    if ((info[2] & (1<<28)) && (info[2] & (1<<27)))
+        return (_xgetbv(0) & 0x6) == 0x6;
+    return false;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+#endif
+}
+
+bool hasSse2()
+{
+#if defined(_MSC_VER) || defined(__x86_64__)
+    return true;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif // NGO_CHECKS_X86
+
+/*! @brief instruction set chosen at the first call */
+struct Dispatch
+{
+    const char * name;
+    BoundsKernel bounds;
+    NonFiniteKernel nonFinite;
+
+    Dispatch() : name("scalar"), bounds(firstOutOfBoundsScalar), nonFinite(firstNonFiniteScalar)
+    {
+#ifdef NGO_CHECKS_X86
+        if (hasAvx())
+        {
+            name = "avx";
+            bounds = firstOutOfBoundsAvx;
+            nonFinite = firstNonFiniteAvx;
+        }
+        else if (hasSse2())
+        {
+            name = "sse2";
+            bounds = firstOutOfBoundsSse2;
+            nonFinite = firstNonFiniteSse2;
+        }
+#endif
+    }
+};
+
+const Dispatch & dispatch()
+{
+    static const Dispatch instance;
+    return instance;
+}
+
+size_t findFirst(const double * values, size_t n, const double * lower, const double * upper, double lo, double hi)
+{
+    size_t i = dispatch().bounds(values,n,lower,upper,lo,hi,0);
+    return i < n ? i : NGO_NPOS;
+}
+
+size_t findAll(const double * values, size_t n, const double * lower, const double * upper, double lo, double hi,
+               std::vector<size_t> & indices)
+{
+    BoundsKernel kernel = dispatch().bounds;
+    size_t found = 0;
+    for (size_t i=kernel(values,n,lower,upper,lo,hi,0);i<n;i=kernel(values,n,lower,upper,lo,hi,i+1))
+    {
+        indices.push_back(i);
+        found++;
+    }
+    return found;
+}
+
+/*! @brief returns the index of the first value of the given kinds at or after start, or n */
+size_t firstOfKinds(NonFiniteKernel kernel, const double * values, size_t n, int kinds, size_t i)
+{
+    for (i=kernel(values,n,i);i<n;i=kernel(values,n,i+1))
+        if (NgoNonFiniteKindOf(values[i]) & kinds)
+            return i;
+    return n;
+}
+
+void raiseOutOfBounds(const double * values, size_t n, size_t i, double lo, double hi,
+                      const std::string & type, int position, const std::string & scope)
+{
+    std::ostringstream desc;
+    desc << "Element " << i << " of an array of " << n << " values is out of bounds";
+    throw NgoErrorOutOfBounds(values[i],lo,hi,type,position,desc.str(),scope);
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   BOUNDS CHECKS DEFINITION
+*******************************************************************************/
+const char * NgoErrorChecksInstructionSet()
+{
+    return dispatch().name;
+}
+
+size_t NgoFindFirstOutOfBounds(const double * values, size_t n, double lower, double upper)
+{
+    return findFirst(values,n,0L,0L,lower,upper);
+}
+
+size_t NgoFindFirstOutOfBounds(const double * values, size_t n, const double * lower, const double * upper)
+{
+    return findFirst(values,n,lower,upper,0.,0.);
+}
+
+size_t NgoFindOutOfBounds(const double * values, size_t n, double lower, double upper, std::vector<size_t> & indices)
+{
+    return findAll(values,n,0L,0L,lower,upper,indices);
+}
+
+size_t NgoFindOutOfBounds(const double * values, size_t n, const double * lower, const double * upper, std::vector<size_t> & indices)
+{
+    return findAll(values,n,lower,upper,0.,0.,indices);
+}
+
+void NgoCheckBounds(const double * values, size_t n, double lower, double upper,
+                    const std::string & type, int position, const std::string & scope)
+{
+    size_t i = findFirst(values,n,0L,0L,lower,upper);
+    if (i != NGO_NPOS)
+        raiseOutOfBounds(values,n,i,lower,upper,type,position,scope);
+}
+
+void NgoCheckBounds(const double * values, size_t n, const double * lower, const double * upper,
+                    const std::string & type, int position, const std::string & scope)
+{
+    size_t i = findFirst(values,n,lower,upper,0.,0.);
+    if (i != NGO_NPOS)
+        raiseOutOfBounds(values,n,i,lower[i],upper[i],type,position,scope);
+}
+
+/*******************************************************************************
+   NON FINITE VALUES CHECKS DEFINITION
+*******************************************************************************/
+int NgoNonFiniteKindOf(double value)
+{
+    if (!isNonFinite(value))
+        return 0;
+    unsigned long long bits, undefined;
+    memcpy(&bits,&value,sizeof(bits));
+    // infinities have a null mantissa
+    if (!(bits & 0x000FFFFFFFFFFFFFULL))
+        return NGO_INF;
+    memcpy(&undefined,&UNDEFERR,sizeof(undefined));
+    return bits == undefined ? NGO_UNDEFERR : NGO_NAN;
+}
+
+size_t NgoFindFirstNonFinite(const double * values, size_t n, int kinds)
+{
+    size_t i = firstOfKinds(dispatch().nonFinite,values,n,kinds,0);
+    return i < n ? i : NGO_NPOS;
+}
+
+size_t NgoFindNonFinite(const double * values, size_t n, std::vector<size_t> & indices, int kinds)
+{
+    NonFiniteKernel kernel = dispatch().nonFinite;
+    size_t found = 0;
+    for (size_t i=firstOfKinds(kernel,values,n,kinds,0);i<n;i=firstOfKinds(kernel,values,n,kinds,i+1))
+    {
+        indices.push_back(i);
+        found++;
+    }
+    return found;
+}
+
+void NgoCheckFinite(const double * values, size_t n, int kinds, const std::string & type, const std::string & scope)
+{
+    size_t i = firstOfKinds(dispatch().nonFinite,values,n,kinds,0);
+    if (i == n)
+        return;
+    std::ostringstream desc;
+    desc << "Element " << i << " of an array of " << n << " values";
+    if (!type.empty())
+        desc << " of type " << type;
+    switch (NgoNonFiniteKindOf(values[i]))
+    {
+    case NGO_INF:
+        desc << " is " << (values[i] > 0 ? "+inf" : "-inf");
+        break;
+    case NGO_UNDEFERR:
+        desc << " is undefined";
+        break;
+    default:
+        desc << " is NaN";
+        break;
+    }
+    throw NgoErrorComputation(desc.str(),scope);
+}
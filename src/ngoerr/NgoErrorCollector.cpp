@@ -0,0 +1,279 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoErrorCollector.cpp
+@date October 2026
+@brief File containing the collector of errors raised by parallel computations
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include "ngoerr/NgoErrorCollector.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+// defined in NgoLogging.cpp
+int NgoErrorSeverity_(const NgoError & er);
+std::string NgoErrorName_(const NgoError & er);
+
+namespace
+{
+/*! @brief returns the list used by the calling thread */
+unsigned threadShard(unsigned shards)
+{
+    static std::atomic<unsigned> counter(0);
+    static thread_local unsigned shard = counter.fetch_add(1,std::memory_order_relaxed);
+    return shard % shards;
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoErrorComposite DEFINITION
+*******************************************************************************/
+NgoErrorComposite::NgoErrorComposite(e_NgoErrorCode code, const std::vector<std::exception_ptr> & errors
+                                     ,std::string desc,std::string scope,std::string ifc,std::string oper)
+                      :NgoError(desc,scope,ifc,oper),errors_(errors)
+{
+   code_ = code;
+   name_ = "Composite";
+};
+
+/*******************************************************************************
+   CLASS NgoErrorCollector DEFINITION
+*******************************************************************************/
+NgoErrorCollector::NgoErrorCollector()
+{
+   for (unsigned i=0;i<SHARDS;i++)
+      shards_[i].head.store(0L,std::memory_order_relaxed);
+}
+
+NgoErrorCollector::~NgoErrorCollector()
+{
+   clear();
+}
+
+void NgoErrorCollector::addCurrent()
+{
+   add(std::current_exception());
+}
+
+void NgoErrorCollector::add(std::exception_ptr exception)
+{
+   if (!exception)
+      return;
+   Node * node = new Node;
+   node->exception = exception;
+   node->error = 0L;
+   push(node);
+}
+
+void NgoErrorCollector::add(const NgoError & er)
+{
+   std::exception_ptr current = std::current_exception();
+   if (current)
+   {
+      // the exception handled may be another one, or er a copy of it caught by value
+      try
+      {
+         std::rethrow_exception(current);
+      }
+      catch (const NgoError & handled)
+      {
+         if (&handled == &er)
+         {
+            add(current);
+            return;
+         }
+      }
+      catch (...)
+      {
+      }
+   }
+   // not the exception handled: keep a copy of its dynamic type, moved into the exception
+   std::unique_ptr<NgoError> copy(er.clone());
+   add(copy->exceptionPtr());
+}
+
+void NgoErrorCollector::push(Node * node)
+{
+   std::atomic<Node *> & head = shards_[threadShard(SHARDS)].head;
+   node->next = head.load(std::memory_order_relaxed);
+   while (!head.compare_exchange_weak(node->next,node,std::memory_order_release,std::memory_order_relaxed))
+      ;
+}
+
+void NgoErrorCollector::resolve(Node & node)
+{
+   if (node.error)
+      return;
+   // the exception object is owned by the exception_ptr: its address stays valid with the node
+   try
+   {
+      std::rethrow_exception(node.exception);
+   }
+   catch (const NgoError & er)
+   {
+      // rendered before the exceptions are handed out by groups, rethrow or the composite error
+      er.what();
+      node.error = &er;
+      return;
+   }
+   catch (const std::exception & e)
+   {
+      node.unknown = NgoErrorUnknown(e.what()).exceptionPtr();
+   }
+   catch (...)
+   {
+      node.unknown = NgoErrorUnknown("Unknown exception").exceptionPtr();
+   }
+   try
+   {
+      std::rethrow_exception(node.unknown);
+   }
+   catch (const NgoError & er)
+   {
+      node.error = &er;
+   }
+}
+
+bool NgoErrorCollector::empty() const
+{
+   for (unsigned i=0;i<SHARDS;i++)
+      if (shards_[i].head.load(std::memory_order_acquire))
+         return false;
+   return true;
+}
+
+size_t NgoErrorCollector::size() const
+{
+   size_t ret = 0;
+   for (unsigned i=0;i<SHARDS;i++)
+      for (Node * node=shards_[i].head.load(std::memory_order_acquire);node;node=node->next)
+         ret++;
+   return ret;
+}
+
+void NgoErrorCollector::clear()
+{
+   for (unsigned i=0;i<SHARDS;i++)
+   {
+      Node * node = shards_[i].head.exchange(0L,std::memory_order_acquire);
+      while (node)
+      {
+         Node * next = node->next;
+         delete node;
+         node = next;
+      }
+   }
+}
+
+namespace
+{
+struct MoreSevere
+{
+   template <class Node>
+   bool operator ()(const Node * a, const Node * b) const
+   {
+      int sa = NgoErrorSeverity_(*a->error);
+      int sb = NgoErrorSeverity_(*b->error);
+      if (sa != sb)
+         return sa > sb;
+      return a->error->getCode() < b->error->getCode();
+   }
+};
+} // end of anonymous namespace
+
+std::vector<NgoErrorCollector::Node *> NgoErrorCollector::sorted() const
+{
+   std::vector<Node *> ret;
+   for (unsigned i=0;i<SHARDS;i++)
+   {
+      size_t begin = ret.size();
+      for (Node * node=shards_[i].head.load(std::memory_order_acquire);node;node=node->next)
+      {
+         resolve(*node);
+         ret.push_back(node);
+      }
+      // lists are built by the head: restore the order of addition
+      std::reverse(ret.begin()+begin,ret.end());
+   }
+   std::stable_sort(ret.begin(),ret.end(),MoreSevere());
+   return ret;
+}
+
+std::vector<NgoErrorCollector::Group> NgoErrorCollector::groups() const
+{
+   std::vector<Group> ret;
+   std::map<std::pair<int,std::string>,size_t> index;
+   std::vector<Node *> nodes = sorted();
+   for (size_t i=0;i<nodes.size();i++)
+   {
+      const NgoError & er = *nodes[i]->error;
+      std::pair<int,std::string> key(er.getCode(),er.getScope());
+      std::map<std::pair<int,std::string>,size_t>::iterator it = index.find(key);
+      if (it != index.end())
+      {
+         ret[it->second].count++;
+         continue;
+      }
+      Group group;
+      group.code = key.first;
+      group.scope = key.second;
+      group.count = 1;
+      group.first = &er;
+      index[key] = ret.size();
+      ret.push_back(group);
+   }
+   return ret;
+}
+
+void NgoErrorCollector::rethrow(Policy policy)
+{
+   std::vector<Node *> nodes = sorted();
+   if (nodes.empty())
+      return;
+   std::exception_ptr mostSevere = nodes[0]->exception;
+   if ((policy == MOST_SEVERE) || (nodes.size() == 1))
+   {
+      clear();
+      std::rethrow_exception(mostSevere);
+   }
+
+   std::vector<Group> grouped = groups();
+   std::ostringstream oss;
+   oss << nodes.size() << " errors occured";
+   for (size_t i=0;i<grouped.size();i++)
+   {
+      oss << "\n" << grouped[i].count << " x " << NgoErrorName_(*grouped[i].first);
+      if (!grouped[i].scope.empty())
+         oss << " in " << grouped[i].scope;
+      oss << " : " << grouped[i].first->getDescription();
+   }
+   std::vector<std::exception_ptr> errors;
+   errors.reserve(nodes.size());
+   for (size_t i=0;i<nodes.size();i++)
+      errors.push_back(nodes[i]->exception);
+   NgoErrorComposite composite((e_NgoErrorCode)nodes[0]->error->getCode(),errors,oss.str());
+   clear();
+   throw composite;
+}
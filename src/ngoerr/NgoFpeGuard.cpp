@@ -0,0 +1,220 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoFpeGuard.cpp
+@date October 2026
+@brief File containing the guard converting floating point exceptions into errors
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <exception>
+#include <mutex>
+#include <sstream>
+
+#include "ngoerr/NgoFpeGuard.h"
+
+#if defined(__GLIBC__) && defined(__x86_64__)
+   #define NGO_FPE_TRAP
+   #include <signal.h>
+   #include <string.h>
+   #include <ucontext.h>
+#endif
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+int uncaughtExceptions()
+{
+#if __cplusplus >= 201703L
+    return std::uncaught_exceptions();
+#else
+    return std::uncaught_exception() ? 1 : 0;
+#endif
+}
+
+/*! @brief innermost trapping guard of the thread */
+thread_local NgoFpeGuard * trapGuard_ = 0L;
+/*! @brief address of the first instruction trapped by the innermost guard */
+thread_local void * trapAddress_ = 0L;
+
+#ifdef NGO_FPE_TRAP
+struct sigaction previousAction_;
+
+int exceptOf(int code)
+{
+    switch (code)
+    {
+    case FPE_FLTINV: return FE_INVALID;
+    case FPE_FLTDIV: return FE_DIVBYZERO;
+    case FPE_FLTOVF: return FE_OVERFLOW;
+    case FPE_FLTUND: return FE_UNDERFLOW;
+    case FPE_FLTRES: return FE_INEXACT;
+    }
+    return 0;
+}
+
+void fpeHandler(int sig, siginfo_t * info, void * context)
+{
+    int except = exceptOf(info->si_code);
+    if (!trapGuard_ || !except)
+    {
+        // not raised in a trapping guard: forwarded to the previous disposition, the handler
+        // staying installed for the guards built later
+        const struct sigaction & previous = previousAction_;
+        const bool sent = info->si_code <= 0;
+        if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+        {
+            if (previous.sa_flags & SA_SIGINFO)
+                previous.sa_sigaction(sig,info,context);
+            else
+                previous.sa_handler(sig);
+            return;
+        }
+        if (previous.sa_handler == SIG_IGN && sent)
+            return;
+        // the default disposition terminates the process: a fault is raised again by the
+        // instruction executed on return, a signal sent by kill or raise is raised again
+        signal(sig,SIG_DFL);
+        if (sent)
+            raise(sig);
+        return;
+    }
+    if (!trapAddress_)
+        trapAddress_ = info->si_addr;
+    // mask the exceptions in the interrupted context: the instruction is executed again without
+    // trap, and sets the exception flag tested on exit of the guard
+    ucontext_t * uc = (ucontext_t *)context;
+    const unsigned excepts = FE_ALL_EXCEPT;
+    uc->uc_mcontext.fpregs->mxcsr |= excepts << 7;
+    uc->uc_mcontext.fpregs->cwd |= excepts;
+}
+
+void installHandler()
+{
+    static std::once_flag once;
+    std::call_once(once,[]() {
+        struct sigaction action;
+        memset(&action,0,sizeof(action));
+        action.sa_sigaction = fpeHandler;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGFPE,&action,&previousAction_);
+    });
+}
+#endif
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoFpeGuard DEFINITION
+*******************************************************************************/
+NgoFpeGuard::NgoFpeGuard(const char * scope, int excepts, Mode mode)
+:scope_(scope ? scope : ""),excepts_(excepts & FE_ALL_EXCEPT),trap_(false),uncaught_(uncaughtExceptions())
+,previous_(0L),previousAddress_(0L)
+{
+   fegetenv(&saved_);
+   feclearexcept(excepts_);
+#ifdef NGO_FPE_TRAP
+   if (mode == TRAP)
+   {
+      installHandler();
+      trap_ = true;
+      previous_ = trapGuard_;
+      previousAddress_ = trapAddress_;
+      trapGuard_ = this;
+      trapAddress_ = 0L;
+      feenableexcept(excepts_);
+   }
+#else
+   (void)mode;
+#endif
+}
+
+NgoFpeGuard::~NgoFpeGuard() noexcept(false)
+{
+   int flags = raised();
+   void * address = 0L;
+   if (trap_)
+   {
+      address = trapAddress_;
+      trapGuard_ = previous_;
+      trapAddress_ = previousAddress_;
+   }
+   // the environment is restored, then the flags raised in the region which this guard does not
+   // watch are set again for the outer guards. They are set without raising, so that no trap
+   // enabled by the restored environment fires here
+   const int others = fetestexcept(FE_ALL_EXCEPT & ~excepts_);
+   fexcept_t othersFlags;
+   fegetexceptflag(&othersFlags,others);
+   fesetenv(&saved_);
+   if (others)
+      fesetexceptflag(&othersFlags,others);
+   if (flags && (uncaughtExceptions() == uncaught_))
+      raise(flags,address);
+}
+
+int NgoFpeGuard::raised() const
+{
+   // trapped exceptions set their flag too, when the instruction is executed again
+   return fetestexcept(excepts_);
+}
+
+void NgoFpeGuard::check()
+{
+   int flags = raised();
+   if (!flags)
+      return;
+   feclearexcept(excepts_);
+   void * address = 0L;
+#ifdef NGO_FPE_TRAP
+   if (trap_)
+   {
+      // the handler masked the exceptions: trap the next ones again
+      address = trapAddress_;
+      trapAddress_ = 0L;
+      feenableexcept(excepts_);
+   }
+#endif
+   raise(flags,address);
+}
+
+void NgoFpeGuard::raise(int flags, void * address)
+{
+   static const struct { int except; const char * name; } names[] = {
+      {FE_INVALID, "invalid operation"},
+      {FE_DIVBYZERO, "division by zero"},
+      {FE_OVERFLOW, "overflow"},
+      {FE_UNDERFLOW, "underflow"},
+      {FE_INEXACT, "inexact result"}
+   };
+   std::ostringstream desc;
+   desc << "Floating point exception:";
+   const char * separator = " ";
+   for (unsigned i=0;i<sizeof(names)/sizeof(names[0]);i++)
+   {
+      if (flags & names[i].except)
+      {
+         desc << separator << names[i].name;
+         separator = ", ";
+      }
+   }
+   if (address)
+      desc << " (first trapped at instruction " << address << ")";
+   throw NgoErrorComputation(desc.str(),scope_);
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLastError.cpp
+@date October 2026
+@brief File containing the last error of a thread reported through the C interface
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2009 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <exception>
+#include <new>
+#include <string>
+
+#include "ngoerr/NgoLastError.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+   /*! @brief last error of a thread */
+   struct NgoLastErrorState
+   {
+      NgoLastErrorState() : code(E_OK) {}
+      int code;
+      std::string description;
+      std::string scope;
+      std::string text;
+   };
+
+   NgoLastErrorState & lastError()
+   {
+      static thread_local NgoLastErrorState state;
+      return state;
+   }
+
+   /*! @brief store an error which is not a NgoError. The strings keep their capacity, so it does
+   not allocate for short messages, as needed after a bad_alloc */
+   int setLastError(int code, const char * description)
+   {
+      NgoLastErrorState & state = lastError();
+      state.code = code;
+      try
+      {
+         state.description = description;
+         state.scope.clear();
+         state.text = description;
+      }
+      catch (...)
+      {
+         state.description.clear();
+         state.text.clear();
+      }
+      return code;
+   }
+}
+
+/*******************************************************************************
+   C INTERFACE DEFINITION
+*******************************************************************************/
+int NgoGetLastErrorCode()
+{
+   return lastError().code;
+}
+
+const char * NgoGetLastErrorDescription()
+{
+   return lastError().description.c_str();
+}
+
+const char * NgoGetLastErrorScope()
+{
+   return lastError().scope.c_str();
+}
+
+const char * NgoGetLastErrorText()
+{
+   return lastError().text.c_str();
+}
+
+void NgoClearLastError()
+{
+   NgoLastErrorState & state = lastError();
+   state.code = E_OK;
+   state.description.clear();
+   state.scope.clear();
+   state.text.clear();
+}
+
+void NgoSetLastError(const NgoError & er)
+{
+   NgoLastErrorState & state = lastError();
+   state.code = er.getCode();
+   try
+   {
+      state.description = er.getDescription();
+      state.scope = er.getScope();
+      state.text = er.what();
+   }
+   catch (std::bad_alloc &)
+   {
+      // keep the code, which is what the caller tests
+      state.description.clear();
+      state.scope.clear();
+      state.text.clear();
+   }
+}
+
+int NgoSetLastErrorFromCurrentException()
+{
+   try
+   {
+      throw;
+   }
+   catch (NgoError & er)
+   {
+      NgoSetLastError(er);
+      // a failure is never reported as a success to the C caller
+      if (er.getCode() == E_OK)
+         lastError().code = E_UNKNOWN;
+      return lastError().code;
+   }
+   catch (std::bad_alloc &)
+   {
+      return setLastError(E_NOMEMORY,"Out of memory");
+   }
+   catch (std::exception & e)
+   {
+      return setLastError(E_UNKNOWN,e.what());
+   }
+   catch (...)
+   {
+      return setLastError(E_UNKNOWN,"Unknown exception");
+   }
+}
@@ -0,0 +1,359 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLogConfig.cpp
+@date October 2026
+@brief File containing the configuration of the log levels at runtime
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <algorithm>
+#include <cstdlib>
+#include <ctype.h>
+#include <errno.h>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+   #include <fcntl.h>
+   #include <poll.h>
+   #include <sys/inotify.h>
+   #include <unistd.h>
+#endif
+
+#include "ngoerr/NgoLogConfig.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+typedef std::vector<std::pair<std::string,int> > NgoLogConfigEntries;
+
+struct NgoLogConfigState
+{
+    NgoLogConfigState() : inotifyFd(-1) {stopPipe[0] = stopPipe[1] = -1;};
+    /*! @brief lock of the configuration and of the categories, taken after the manager lock */
+    std::mutex mutex;
+    NgoLogConfigEntries entries;
+    std::string text;
+    std::vector<NgoLogCategoryLevel *> categories;
+    /*! @brief file read by reload */
+    std::string filename;
+
+    /*! @brief lock of the watch */
+    std::mutex watchMutex;
+    std::thread watcher;
+    int inotifyFd;
+    /*! @brief written to stop the watcher */
+    int stopPipe[2];
+};
+
+/*! @brief never freed, as the categories unregister themselves at exit */
+NgoLogConfigState & configState()
+{
+    static NgoLogConfigState * state = new NgoLogConfigState();
+    return *state;
+}
+
+std::string trim(const std::string & s)
+{
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && isspace((unsigned char)s[begin]))
+        begin++;
+    while (end > begin && isspace((unsigned char)s[end-1]))
+        end--;
+    return s.substr(begin,end-begin);
+}
+
+int parseLevel(std::string name)
+{
+    for (size_t i=0;i<name.size();i++)
+        name[i] = (char)toupper((unsigned char)name[i]);
+    for (int level=logERROR;level<=logDEBUG4;level++)
+        if (name == NgoLoggerManager::toString(TLogLevel(level)))
+            return level;
+    return -1;
+}
+
+NgoLogConfigEntries parse(const std::string & levels)
+{
+    NgoLogConfigEntries entries;
+    size_t i = 0;
+    while (i < levels.size())
+    {
+        size_t end = levels.find_first_of("\n;,#",i);
+        if (end == std::string::npos)
+            end = levels.size();
+        const std::string item = trim(levels.substr(i,end-i));
+        if (end < levels.size() && levels[end] == '#')
+        {
+            end = levels.find('\n',end);
+            if (end == std::string::npos)
+                end = levels.size();
+        }
+        i = end+1;
+        if (item.empty())
+            continue;
+        const size_t equal = item.find('=');
+        const std::string name = trim(item.substr(0,equal));
+        const int level = equal == std::string::npos ? -1 : parseLevel(trim(item.substr(equal+1)));
+        if (name.empty() || level < 0)
+            throw NgoErrorInvalidArgument(1,"Invalid log level configuration '" + item + "'","NgoLogConfig::configure");
+        entries.push_back(std::make_pair(name,level));
+    }
+    return entries;
+}
+
+/*! @brief configured level of a name, -1 if the configuration does not name it */
+int levelOf(const NgoLogConfigEntries & entries, const std::string & name, bool logger)
+{
+    int level = -1;
+    for (size_t i=0;i<entries.size();i++)
+        if (entries[i].first == name || (logger && entries[i].first == "*"))
+            level = entries[i].second;
+    return level;
+}
+
+bool readFile(const std::string & filename, std::string & text)
+{
+    FILE * file = fopen(filename.c_str(),"r");
+    if (!file)
+        return false;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer,1,sizeof(buffer),file)) > 0)
+        text.append(buffer,n);
+    fclose(file);
+    return true;
+}
+
+#ifdef __linux__
+void watchLoop(int inotifyFd, int stopFd, std::string basename)
+{
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+        struct pollfd fds[2] = {{inotifyFd,POLLIN,0},{stopFd,POLLIN,0}};
+        if (poll(fds,2,-1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[1].revents)
+            return;
+        const ssize_t n = read(inotifyFd,buffer,sizeof(buffer));
+        if (n <= 0)
+            continue;
+        bool changed = false;
+        for (const char * p=buffer;p<buffer+n;)
+        {
+            const struct inotify_event * event = (const struct inotify_event *)p;
+            if (event->len && basename == event->name)
+                changed = true;
+            p += sizeof(struct inotify_event)+event->len;
+        }
+        if (!changed)
+            continue;
+        try
+        {
+            NgoLogConfig::reload();
+        }
+        catch (NgoError & er)
+        {
+            NGOLOG(logWARNING) << "Log levels not reloaded: " << er.getDescription();
+        }
+    }
+}
+#endif
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoLogCategoryLevel DEFINITION
+*******************************************************************************/
+NgoLogCategoryLevel::NgoLogCategoryLevel(const char * name)
+:name_(name),level_(logDEBUG4)
+{
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.categories.push_back(this);
+    const int level = levelOf(c.entries,name_,false);
+    if (level >= 0)
+        level_.store(level,std::memory_order_relaxed);
+}
+
+NgoLogCategoryLevel::~NgoLogCategoryLevel()
+{
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    std::vector<NgoLogCategoryLevel *>::iterator it = std::find(c.categories.begin(),c.categories.end(),this);
+    if (it != c.categories.end())
+        c.categories.erase(it);
+}
+
+/*******************************************************************************
+   CLASS NgoLogConfig DEFINITION
+*******************************************************************************/
+void NgoLogConfig::configure(const std::string & levels)
+{
+    NgoLogConfigEntries entries = parse(levels);
+    NgoLoggerManager * manager = NgoLoggerManager::get();
+    NgoLogConfigState & c = configState();
+    // loggers and categories change together: a log is dispatched before or after
+    std::lock_guard<std::recursive_mutex> lock(manager->mutex());
+    {
+        std::lock_guard<std::mutex> lockConfig(c.mutex);
+        c.entries.swap(entries);
+        c.text = levels;
+        for (size_t i=0;i<c.categories.size();i++)
+        {
+            const int level = levelOf(c.entries,c.categories[i]->name(),false);
+            c.categories[i]->level_.store(level >= 0 ? level : logDEBUG4,std::memory_order_relaxed);
+        }
+    }
+    std::vector<NgoLogger *> & loggers = manager->loggers();
+    for (size_t i=0;i<loggers.size();i++)
+        apply(loggers[i]);
+    manager->updateReportingLevel();
+}
+
+void NgoLogConfig::load(const std::string & filename)
+{
+    std::string text;
+    if (!readFile(filename,text))
+        throw NgoError("Impossible to read the log configuration " + filename,"NgoLogConfig::load");
+    {
+        NgoLogConfigState & c = configState();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.filename = filename;
+    }
+    reload();
+}
+
+bool NgoLogConfig::reload()
+{
+    std::string levels;
+    bool found = false;
+    const char * environment = getenv(NGOLOG_LEVELS_ENV);
+    if (environment)
+    {
+        levels = environment;
+        found = true;
+    }
+    std::string filename;
+    {
+        NgoLogConfigState & c = configState();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        filename = c.filename;
+    }
+    std::string text;
+    if (!filename.empty() && readFile(filename,text))
+    {
+        levels += "\n";
+        levels += text;
+        found = true;
+    }
+    if (!found)
+        return false;
+    configure(levels);
+    return true;
+}
+
+void NgoLogConfig::watch(const std::string & filename)
+{
+    load(filename);
+    unwatch();
+#ifdef __linux__
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.watchMutex);
+    // the directory is watched, as editors replace the file rather than write it
+    const size_t slash = filename.rfind('/');
+    const std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : filename.substr(0,slash));
+    const std::string basename = slash == std::string::npos ? filename : filename.substr(slash+1);
+    c.inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (c.inotifyFd < 0)
+        throw NgoError("Impossible to watch the log configuration " + filename,"NgoLogConfig::watch");
+    if (inotify_add_watch(c.inotifyFd,directory.c_str(),IN_CLOSE_WRITE | IN_MOVED_TO) < 0
+        || pipe(c.stopPipe) != 0)
+    {
+        close(c.inotifyFd);
+        c.inotifyFd = -1;
+        throw NgoError("Impossible to watch the log configuration " + filename,"NgoLogConfig::watch");
+    }
+    c.watcher = std::thread(watchLoop,c.inotifyFd,c.stopPipe[0],basename);
+#endif
+}
+
+void NgoLogConfig::unwatch()
+{
+#ifdef __linux__
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.watchMutex);
+    if (!c.watcher.joinable())
+        return;
+    if (write(c.stopPipe[1],"",1) != 1)
+        return;
+    c.watcher.join();
+    close(c.stopPipe[0]);
+    close(c.stopPipe[1]);
+    close(c.inotifyFd);
+    c.stopPipe[0] = c.stopPipe[1] = c.inotifyFd = -1;
+#endif
+}
+
+std::string NgoLogConfig::current()
+{
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.text;
+}
+
+void NgoLogConfig::apply(NgoLogger * logger)
+{
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    const int level = levelOf(c.entries,logger->name_,true);
+    if (level >= 0)
+    {
+        if (!logger->configured_)
+            logger->codeLevel_ = logger->reportingLevel_;
+        logger->configured_ = true;
+        logger->reportingLevel_ = TLogLevel(level);
+    }
+    else if (logger->configured_)
+    {
+        logger->reportingLevel_ = logger->codeLevel_;
+        logger->configured_ = false;
+    }
+}
+
+void NgoLogConfig::reset()
+{
+    unwatch();
+    NgoLogConfigState & c = configState();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.entries.clear();
+    c.text.clear();
+    c.filename.clear();
+    for (size_t i=0;i<c.categories.size();i++)
+        c.categories[i]->level_.store(logDEBUG4,std::memory_order_relaxed);
+}
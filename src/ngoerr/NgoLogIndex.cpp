@@ -0,0 +1,480 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLogIndex.cpp
+@date October 2026
+@brief File containing the sidecar index of the log files and the queries on it
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <chrono>
+#include <limits>
+#include <string.h>
+#include <thread>
+#ifndef _WIN32
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
+#include "ngoerr/NgoLogIndex.h"
+#include "ngoerr/NgoLoggerCompressed.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+#ifdef _WIN32
+   #define NGO_FSEEK64(file,offset) _fseeki64(file,(__int64)(offset),SEEK_SET)
+#else
+   #define NGO_FSEEK64(file,offset) fseeko(file,(off_t)(offset),SEEK_SET)
+#endif
+
+static_assert(sizeof(NgoLogIndexEntry) == 32, "the index entries are written as is");
+
+namespace
+{
+/*! @brief smallest number of index entries given to a thread */
+const size_t MIN_ENTRIES_PER_THREAD = 1 << 16;
+/*! @brief smallest part of a text file given to a thread */
+const size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+unsigned threadCount(unsigned threads, size_t work, size_t minWorkPerThread)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    size_t most = work/minWorkPerThread;
+    if (threads > most)
+        threads = (unsigned)most;
+    return threads ? threads : 1;
+}
+
+/*! @brief calls f(part) for part in [0,n), on n threads, the calling thread taking the first part */
+template <class F>
+void runParts(unsigned n, F f)
+{
+    std::vector<std::thread> workers;
+    for (unsigned part=1;part<n;part++)
+        workers.push_back(std::thread(f,part));
+    f(0);
+    for (size_t i=0;i<workers.size();i++)
+        workers[i].join();
+}
+
+/*! @brief level of a record starting at p, -1 if no record starts at p */
+int recordLevel(const char * p, const char * end)
+{
+    const char * tab = p;
+    while (tab < end && tab-p < 8 && *tab != '\t')
+        tab++;
+    if (tab == end || *tab != '\t')
+        return -1;
+    static const std::vector<std::string> names = []() {
+        std::vector<std::string> names;
+        for (int level=logERROR;level<=logDEBUG4;level++)
+            names.push_back(NgoLoggerManager::toString(TLogLevel(level)));
+        return names;
+    }();
+    for (size_t level=0;level<names.size();level++)
+        if (names[level].size() == (size_t)(tab-p) && memcmp(names[level].data(),p,names[level].size()) == 0)
+            return (int)level;
+    return -1;
+}
+
+/*! @brief entries of the records of text[begin,limit) matching query. The last record ends at the
+next record start, which may be after limit */
+void scanText(const char * text, size_t size, size_t begin, size_t limit, const NgoLogQuery & query,
+              uint64_t block, uint8_t flags, std::vector<NgoLogIndexEntry> & entries)
+{
+    const char * const end = text+size;
+    // align on the start of a line
+    const char * p = text+begin;
+    if (begin > 0 && p[-1] != '\n')
+    {
+        p = (const char *)memchr(p,'\n',end-p);
+        p = p ? p+1 : end;
+    }
+    bool open = false;
+    while (p < text+limit)
+    {
+        const char * eol = (const char *)memchr(p,'\n',end-p);
+        const char * next = eol ? eol+1 : end;
+        int level = recordLevel(p,end);
+        if (level >= 0)
+        {
+            if (open)
+                entries.back().length = (uint32_t)((p-text)-entries.back().offset);
+            open = level <= query.level;
+            if (open)
+            {
+                NgoLogIndexEntry entry;
+                memset(&entry,0,sizeof(entry));
+                entry.offset = p-text;
+                entry.block = block;
+                entry.level = (int8_t)level;
+                entry.flags = flags;
+                entries.push_back(entry);
+            }
+        }
+        p = next;
+    }
+    if (!open)
+        return;
+    // the last record selected goes on until the next record start
+    while (p < end && recordLevel(p,end) < 0)
+    {
+        const char * eol = (const char *)memchr(p,'\n',end-p);
+        p = eol ? eol+1 : end;
+    }
+    entries.back().length = (uint32_t)((p-text)-entries.back().offset);
+}
+
+void concatenate(std::vector<std::vector<NgoLogIndexEntry> > & parts, std::vector<NgoLogIndexEntry> & all)
+{
+    size_t total = 0;
+    for (size_t i=0;i<parts.size();i++)
+        total += parts[i].size();
+    all.reserve(total);
+    for (size_t i=0;i<parts.size();i++)
+        all.insert(all.end(),parts[i].begin(),parts[i].end());
+}
+
+std::vector<NgoLogIndexEntry> scanCompressed(FILE * file, const std::string & filename,
+                                             const NgoLogQuery & query, unsigned threads)
+{
+    // offsets of the blocks, from their headers only
+    std::vector<uint64_t> blocks;
+    uint64_t offset = 8;
+    unsigned char header[NGOLOG_BLOCK_HEADER_SIZE];
+    while (NGO_FSEEK64(file,offset) == 0 && fread(header,1,sizeof(header),file) == sizeof(header))
+    {
+        blocks.push_back(offset);
+        const uint32_t stored = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+        offset += sizeof(header)+stored;
+    }
+    const unsigned n = threadCount(threads,blocks.size(),1);
+    std::vector<std::vector<NgoLogIndexEntry> > parts(n);
+    std::vector<std::string> errors(n);
+    runParts(n,[&](unsigned part) {
+        try
+        {
+            NgoLogCompressedReader reader(filename);
+            std::string text;
+            for (size_t b=part;b<blocks.size();b+=n)
+            {
+                reader.seek(blocks[b]);
+                if (reader.next(text))
+                    scanText(text.data(),text.size(),0,text.size(),query,blocks[b],NGOLOG_INDEX_IN_BLOCK,parts[part]);
+            }
+        }
+        catch (NgoError & er)
+        {
+            errors[part] = er.getDescription();
+        }
+    });
+    for (unsigned part=0;part<n;part++)
+        if (!errors[part].empty())
+            throw NgoError(errors[part],"NgoLogScan");
+    // the blocks were dealt round robin: put the entries back in the order of the file
+    std::vector<NgoLogIndexEntry> all;
+    std::vector<size_t> next(n,0);
+    for (size_t b=0;b<blocks.size();b++)
+    {
+        std::vector<NgoLogIndexEntry> & entries = parts[b%n];
+        size_t & i = next[b%n];
+        while (i < entries.size() && entries[i].block == blocks[b])
+            all.push_back(entries[i++]);
+    }
+    return all;
+}
+} // end of anonymous namespace
+
+int64_t NgoLogIndexTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/*******************************************************************************
+   CLASS NgoLogIndexWriter DEFINITION
+*******************************************************************************/
+NgoLogIndexWriter::NgoLogIndexWriter(std::string filename, bool append)
+:file_(0L)
+{
+    file_ = fopen(filename.c_str(),append ? "ab" : "wb");
+    if (!file_)
+        throw NgoError("Impossible to create log index " + filename,"NgoLogIndexWriter");
+    fseek(file_,0,SEEK_END);
+    if (ftell(file_) == 0)
+    {
+        char header[NGOLOG_INDEX_HEADER_SIZE];
+        const uint32_t entrySize = sizeof(NgoLogIndexEntry);
+        const uint32_t one = 1;
+        memcpy(header,NGOLOG_INDEX_MAGIC,8);
+        memcpy(header+8,&entrySize,4);
+        memcpy(header+12,&one,4);
+        fwrite(header,1,sizeof(header),file_);
+    }
+}
+
+NgoLogIndexWriter::~NgoLogIndexWriter()
+{
+    flush();
+    fclose(file_);
+}
+
+void NgoLogIndexWriter::write()
+{
+    if (!pending_.empty())
+        fwrite(pending_.data(),sizeof(NgoLogIndexEntry),pending_.size(),file_);
+    pending_.clear();
+}
+
+void NgoLogIndexWriter::flush()
+{
+    write();
+    fflush(file_);
+}
+
+/*******************************************************************************
+   STRUCT NgoLogQuery DEFINITION
+*******************************************************************************/
+NgoLogQuery::NgoLogQuery()
+:level(logDEBUG4),from(std::numeric_limits<int64_t>::min()),to(std::numeric_limits<int64_t>::max()),code(-1)
+{
+}
+
+bool NgoLogQuery::levelOnly() const
+{
+    return from == std::numeric_limits<int64_t>::min() && to == std::numeric_limits<int64_t>::max() && code < 0;
+}
+
+/*******************************************************************************
+   CLASS NgoLogIndex DEFINITION
+*******************************************************************************/
+NgoLogIndex::NgoLogIndex(std::string logFilename)
+:entries_(0L),size_(0),mapping_(0L),mappedSize_(0)
+{
+    const std::string filename = logFilename + NGOLOG_INDEX_SUFFIX;
+    char header[NGOLOG_INDEX_HEADER_SIZE];
+    bool valid = false;
+#ifndef _WIN32
+    int fd = open(filename.c_str(),O_RDONLY);
+    if (fd < 0)
+        throw NgoError("Impossible to open log index " + filename,"NgoLogIndex");
+    struct stat st;
+    if (fstat(fd,&st) == 0 && st.st_size >= NGOLOG_INDEX_HEADER_SIZE)
+    {
+        mappedSize_ = (size_t)st.st_size;
+        mapping_ = mmap(0L,mappedSize_,PROT_READ,MAP_SHARED,fd,0);
+        if (mapping_ == MAP_FAILED)
+            mapping_ = 0L;
+    }
+    close(fd);
+    if (mapping_)
+    {
+        memcpy(header,mapping_,sizeof(header));
+        valid = true;
+    }
+#else
+    FILE * file = fopen(filename.c_str(),"rb");
+    if (!file)
+        throw NgoError("Impossible to open log index " + filename,"NgoLogIndex");
+    valid = fread(header,1,sizeof(header),file) == sizeof(header);
+    NgoLogIndexEntry entry;
+    while (valid && fread(&entry,sizeof(entry),1,file) == 1)
+        copy_.push_back(entry);
+    fclose(file);
+#endif
+    uint32_t entrySize = 0;
+    uint32_t one = 0;
+    memcpy(&entrySize,header+8,4);
+    memcpy(&one,header+12,4);
+    if (!valid || memcmp(header,NGOLOG_INDEX_MAGIC,8) != 0 || entrySize != sizeof(NgoLogIndexEntry) || one != 1)
+    {
+#ifndef _WIN32
+        if (mapping_)
+            munmap(mapping_,mappedSize_);
+#endif
+        throw NgoError(filename + " is not a log index of this version and byte order","NgoLogIndex");
+    }
+    if (mapping_)
+    {
+#ifndef _WIN32
+        madvise(mapping_,mappedSize_,MADV_SEQUENTIAL);
+#endif
+        entries_ = (const NgoLogIndexEntry *)((const char *)mapping_+NGOLOG_INDEX_HEADER_SIZE);
+        // an entry being written by the logger is ignored
+        size_ = (mappedSize_-NGOLOG_INDEX_HEADER_SIZE)/sizeof(NgoLogIndexEntry);
+    }
+    else
+    {
+        entries_ = copy_.data();
+        size_ = copy_.size();
+    }
+}
+
+NgoLogIndex::~NgoLogIndex()
+{
+#ifndef _WIN32
+    if (mapping_)
+        munmap(mapping_,mappedSize_);
+#endif
+}
+
+std::vector<size_t> NgoLogIndex::select(const NgoLogQuery & query, unsigned threads) const
+{
+    const unsigned n = threadCount(threads,size_,MIN_ENTRIES_PER_THREAD);
+    std::vector<std::vector<size_t> > parts(n);
+    runParts(n,[&](unsigned part) {
+        const size_t begin = size_*part/n;
+        const size_t end = size_*(part+1)/n;
+        for (size_t i=begin;i<end;i++)
+            if (query.matches(entries_[i]))
+                parts[part].push_back(i);
+    });
+    if (n == 1)
+        return parts[0];
+    std::vector<size_t> all;
+    for (unsigned part=0;part<n;part++)
+        all.insert(all.end(),parts[part].begin(),parts[part].end());
+    return all;
+}
+
+/*******************************************************************************
+   SCAN WITHOUT INDEX
+*******************************************************************************/
+std::vector<NgoLogIndexEntry> NgoLogScan(std::string filename, const NgoLogQuery & query, unsigned threads)
+{
+    if (!query.levelOnly())
+        throw NgoErrorInvalidArgument(2,"Times and codes can only be queried with an index","NgoLogScan");
+    FILE * file = fopen(filename.c_str(),"rb");
+    if (!file)
+        throw NgoError("Impossible to open log file " + filename,"NgoLogScan");
+    char magic[8];
+    if (fread(magic,1,8,file) == 8 && memcmp(magic,NGOLOG_COMPRESSED_MAGIC,8) == 0)
+    {
+        std::vector<NgoLogIndexEntry> entries;
+        try
+        {
+            entries = scanCompressed(file,filename,query,threads);
+        }
+        catch (...)
+        {
+            fclose(file);
+            throw;
+        }
+        fclose(file);
+        return entries;
+    }
+
+    const char * text = 0L;
+    size_t size = 0;
+#ifndef _WIN32
+    fclose(file);
+    void * mapping = 0L;
+    int fd = open(filename.c_str(),O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd,&st) == 0 && st.st_size > 0)
+    {
+        size = (size_t)st.st_size;
+        mapping = mmap(0L,size,PROT_READ,MAP_SHARED,fd,0);
+        if (mapping == MAP_FAILED)
+            mapping = 0L;
+    }
+    if (fd >= 0)
+        close(fd);
+    if (!mapping)
+        return std::vector<NgoLogIndexEntry>();
+    text = (const char *)mapping;
+#else
+    std::string content;
+    fseek(file,0,SEEK_SET);
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer,1,sizeof(buffer),file)) > 0)
+        content.append(buffer,n);
+    fclose(file);
+    text = content.data();
+    size = content.size();
+#endif
+
+    const unsigned n = threadCount(threads,size,MIN_BYTES_PER_THREAD);
+    std::vector<std::vector<NgoLogIndexEntry> > parts(n);
+    runParts(n,[&](unsigned part) {
+        scanText(text,size,size*part/n,size*(part+1)/n,query,0,0,parts[part]);
+    });
+#ifndef _WIN32
+    munmap(mapping,size);
+#endif
+    std::vector<NgoLogIndexEntry> all;
+    concatenate(parts,all);
+    return all;
+}
+
+/*******************************************************************************
+   CLASS NgoLogRecordReader DEFINITION
+*******************************************************************************/
+NgoLogRecordReader::NgoLogRecordReader(std::string filename)
+:file_(0L),compressed_(0L),block_(0)
+{
+    file_ = fopen(filename.c_str(),"rb");
+    if (!file_)
+        throw NgoError("Impossible to open log file " + filename,"NgoLogRecordReader");
+    char magic[8];
+    if (fread(magic,1,8,file_) == 8 && memcmp(magic,NGOLOG_COMPRESSED_MAGIC,8) == 0)
+    {
+        fclose(file_);
+        file_ = 0L;
+        compressed_ = new NgoLogCompressedReader(filename);
+    }
+}
+
+NgoLogRecordReader::~NgoLogRecordReader()
+{
+    if (file_)
+        fclose(file_);
+    delete compressed_;
+}
+
+const std::string & NgoLogRecordReader::read(const NgoLogIndexEntry & entry)
+{
+    if (entry.flags & NGOLOG_INDEX_IN_BLOCK)
+    {
+        if (!compressed_)
+            throw NgoError("Entry of a compressed block in a text log file","NgoLogRecordReader::read");
+        if (blockText_.empty() || block_ != entry.block)
+        {
+            compressed_->seek(entry.block);
+            if (!compressed_->next(blockText_))
+                throw NgoError("Entry of a block after the end of the log file","NgoLogRecordReader::read");
+            block_ = entry.block;
+        }
+        if (entry.offset+entry.length > blockText_.size())
+            throw NgoError("Entry out of its block","NgoLogRecordReader::read");
+        record_.assign(blockText_,(size_t)entry.offset,entry.length);
+        return record_;
+    }
+    if (!file_)
+        throw NgoError("Entry of a text file in a compressed log file","NgoLogRecordReader::read");
+    record_.resize(entry.length);
+    if (entry.length && (NGO_FSEEK64(file_,entry.offset) != 0
+                         || fread(&record_[0],1,entry.length,file_) != entry.length))
+        throw NgoError("Entry after the end of the log file","NgoLogRecordReader::read");
+    return record_;
+}
@@ -0,0 +1,445 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLoggerCompressed.cpp
+@date October 2026
+@brief File containing the logger to a file of compressed blocks and its codec
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <string.h>
+#include <utility>
+
+#include "ngoerr/NgoLoggerCompressed.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+/*! @brief length of the shortest match */
+const size_t MIN_MATCH = 4;
+/*! @brief the last bytes of a block are always literals */
+const size_t LAST_LITERALS = 5;
+/*! @brief no match starts in the last bytes of a block */
+const size_t MATCH_FIND_LIMIT = 12;
+/*! @brief farthest match */
+const size_t MAX_OFFSET = 65535;
+const int HASH_LOG = 12;
+#ifdef _WIN32
+   #define NGO_FSEEK64(file,offset) _fseeki64(file,(__int64)(offset),SEEK_SET)
+#else
+   #define NGO_FSEEK64(file,offset) fseeko(file,(off_t)(offset),SEEK_SET)
+#endif
+
+/*! @brief number of blocks the background thread may be behind before the loggers wait */
+const size_t MAX_QUEUED_BLOCKS = 4;
+
+inline uint32_t read32(const unsigned char * p)
+{
+    uint32_t value;
+    memcpy(&value,p,4);
+    return value;
+}
+
+inline uint32_t hash4(uint32_t sequence)
+{
+    return (sequence*2654435761u) >> (32-HASH_LOG);
+}
+
+unsigned char * writeLength(unsigned char * op, size_t length)
+{
+    while (length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+bool readLength(const unsigned char *& ip, const unsigned char * end, size_t & length)
+{
+    unsigned char byte;
+    do
+    {
+        if (ip >= end)
+            return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/*! @brief writes a sequence: literals followed by a match, the match being omitted for the last one */
+unsigned char * writeSequence(unsigned char * op, const unsigned char * literals, size_t nLiterals,
+                              size_t offset, size_t matchLength, bool last)
+{
+    const size_t matchCode = last ? 0 : matchLength-MIN_MATCH;
+    unsigned char * token = op++;
+    *token = (unsigned char)(((nLiterals >= 15 ? 15 : nLiterals) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    if (nLiterals >= 15)
+        op = writeLength(op,nLiterals-15);
+    memcpy(op,literals,nLiterals);
+    op += nLiterals;
+    if (last)
+        return op;
+    *op++ = (unsigned char)(offset & 255);
+    *op++ = (unsigned char)(offset >> 8);
+    if (matchCode >= 15)
+        op = writeLength(op,matchCode-15);
+    return op;
+}
+
+uint32_t fnv1a(const char * data, size_t n)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i=0;i<n;i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void put32(unsigned char * p, uint32_t value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+uint32_t get32(const unsigned char * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CODEC DEFINITION
+*******************************************************************************/
+size_t NgoLogCompressBound(size_t n)
+{
+    return n + n/255 + 16;
+}
+
+size_t NgoLogCompress(const char * src, size_t n, char * dst, size_t capacity)
+{
+    if (capacity < NgoLogCompressBound(n))
+        return 0;
+    const unsigned char * const base = (const unsigned char *)src;
+    const unsigned char * const end = base+n;
+    const unsigned char * ip = base;
+    const unsigned char * anchor = base;
+    unsigned char * op = (unsigned char *)dst;
+
+    if (n >= MATCH_FIND_LIMIT)
+    {
+        // positions of the last occurrences of the hashed 4 bytes sequences
+        uint32_t table[1 << HASH_LOG];
+        memset(table,0,sizeof(table));
+        const unsigned char * const findLimit = end-MATCH_FIND_LIMIT;
+        const unsigned char * const matchLimit = end-LAST_LITERALS;
+        while (ip < findLimit)
+        {
+            const uint32_t sequence = read32(ip);
+            const uint32_t h = hash4(sequence);
+            const unsigned char * ref = base+table[h];
+            table[h] = (uint32_t)(ip-base);
+            if (ref >= ip || (size_t)(ip-ref) > MAX_OFFSET || read32(ref) != sequence)
+            {
+                ip++;
+                continue;
+            }
+            const unsigned char * matchEnd = ip+MIN_MATCH;
+            const unsigned char * refEnd = ref+MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *refEnd)
+            {
+                matchEnd++;
+                refEnd++;
+            }
+            op = writeSequence(op,anchor,ip-anchor,ip-ref,matchEnd-ip,false);
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+    op = writeSequence(op,anchor,end-anchor,0,0,true);
+    return op-(unsigned char *)dst;
+}
+
+bool NgoLogDecompress(const char * src, size_t n, char * dst, size_t rawSize)
+{
+    const unsigned char * ip = (const unsigned char *)src;
+    const unsigned char * const end = ip+n;
+    char * op = dst;
+    char * const outEnd = dst+rawSize;
+    while (ip < end)
+    {
+        const unsigned token = *ip++;
+        size_t nLiterals = token >> 4;
+        if (nLiterals == 15 && !readLength(ip,end,nLiterals))
+            return false;
+        if ((size_t)(end-ip) < nLiterals || (size_t)(outEnd-op) < nLiterals)
+            return false;
+        memcpy(op,ip,nLiterals);
+        op += nLiterals;
+        ip += nLiterals;
+        if (ip == end)
+            break;
+
+        if (end-ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op-dst))
+            return false;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip,end,matchLength))
+            return false;
+        matchLength += MIN_MATCH;
+        if ((size_t)(outEnd-op) < matchLength)
+            return false;
+        const char * ref = op-offset;
+        if (offset >= matchLength)
+            memcpy(op,ref,matchLength);
+        else
+            for (size_t i=0;i<matchLength;i++)
+                op[i] = ref[i];
+        op += matchLength;
+    }
+    return op == outEnd;
+}
+
+/*******************************************************************************
+   CLASS NgoLoggerCompressed DEFINITION
+*******************************************************************************/
+NgoLoggerCompressed::NgoLoggerCompressed(std::string filename, size_t blockSize, TLogLevel reportingLevel, bool append, bool index)
+:NgoLogger(reportingLevel,false),file_(0L),blockSize_(blockSize ? blockSize : 1),index_(0L),fileOffset_(0),writing_(false),stop_(false)
+{
+    file_ = fopen(filename.c_str(),append ? "ab" : "wb");
+    if (!file_)
+        throw NgoError("Impossible to create logger file");
+    fseek(file_,0,SEEK_END);
+    if (ftell(file_) == 0)
+        fwrite(NGOLOG_COMPRESSED_MAGIC,1,8,file_);
+    fflush(file_);
+#ifdef _WIN32
+    fileOffset_ = (uint64_t)_ftelli64(file_);
+#else
+    fileOffset_ = (uint64_t)ftello(file_);
+#endif
+    if (index)
+        index_ = new NgoLogIndexWriter(filename + NGOLOG_INDEX_SUFFIX,append);
+    current_.text.reserve(blockSize_);
+    worker_ = std::thread(&NgoLoggerCompressed::run,this);
+    registerLogger();
+}
+
+NgoLoggerCompressed::~NgoLoggerCompressed()
+{
+    unregisterLogger();
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    ready_.notify_one();
+    worker_.join();
+    delete index_;
+    fclose(file_);
+}
+
+void NgoLoggerCompressed::output(const TLogLevel level, std::string & log)
+{
+    if (level>reportingLevel_)
+        return;
+    // a block only holds whole records
+    if (!current_.text.empty() && current_.text.size()+log.size() > blockSize_)
+        submit();
+    if (index_)
+    {
+        NgoLogIndexEntry entry;
+        entry.offset = current_.text.size();
+        entry.block = 0;
+        entry.time = NgoLogIndexTime();
+        entry.length = (uint32_t)log.size();
+        entry.code = (int16_t)NgoLoggerManager::get()->recordCode();
+        entry.level = (int8_t)level;
+        entry.flags = NGOLOG_INDEX_IN_BLOCK;
+        current_.entries.push_back(entry);
+    }
+    current_.text += log;
+    if (current_.text.size() >= blockSize_)
+        submit();
+}
+
+void NgoLoggerCompressed::flush()
+{
+    if (!current_.text.empty())
+        submit();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock,[this]() {return queue_.empty() && !writing_;});
+    fflush(file_);
+    // the background thread is idle: the index can be written from here
+    if (index_)
+        index_->flush();
+}
+
+void NgoLoggerCompressed::submit()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock,[this]() {return queue_.size() < MAX_QUEUED_BLOCKS;});
+    queue_.push_back(Block());
+    std::swap(queue_.back(),current_);
+    if (!free_.empty())
+    {
+        std::swap(current_,free_.back());
+        free_.pop_back();
+    }
+    lock.unlock();
+    ready_.notify_one();
+    current_.text.reserve(blockSize_);
+}
+
+void NgoLoggerCompressed::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        ready_.wait(lock,[this]() {return stop_ || !queue_.empty();});
+        if (queue_.empty())
+            return;
+        Block block;
+        std::swap(block,queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+        lock.unlock();
+
+        writeBlock(block);
+
+        lock.lock();
+        block.text.clear();
+        block.entries.clear();
+        free_.push_back(Block());
+        std::swap(free_.back(),block);
+        writing_ = false;
+        done_.notify_all();
+    }
+}
+
+void NgoLoggerCompressed::writeBlock(Block & current)
+{
+    const std::string & block = current.text;
+    compressed_.resize(NgoLogCompressBound(block.size()));
+    size_t stored = NgoLogCompress(block.data(),block.size(),&compressed_[0],compressed_.size());
+    const char * data = &compressed_[0];
+    if (stored == 0 || stored >= block.size())
+    {
+        stored = block.size();
+        data = block.data();
+    }
+    unsigned char header[NGOLOG_BLOCK_HEADER_SIZE];
+    memcpy(header,NGOLOG_BLOCK_MAGIC,4);
+    put32(header+4,(uint32_t)block.size());
+    put32(header+8,(uint32_t)stored);
+    put32(header+12,fnv1a(block.data(),block.size()));
+    fwrite(header,1,sizeof(header),file_);
+    fwrite(data,1,stored,file_);
+    if (index_)
+        for (size_t i=0;i<current.entries.size();i++)
+        {
+            current.entries[i].block = fileOffset_;
+            index_->add(current.entries[i]);
+        }
+    fileOffset_ += sizeof(header)+stored;
+}
+
+/*******************************************************************************
+   CLASS NgoLogCompressedReader DEFINITION
+*******************************************************************************/
+NgoLogCompressedReader::NgoLogCompressedReader(std::string filename)
+:file_(0L),filename_(filename),storedBytes_(0)
+{
+    file_ = fopen(filename.c_str(),"rb");
+    if (!file_)
+        throw NgoError("Impossible to open compressed log file "+filename,"NgoLogCompressedReader");
+    char magic[8];
+    if (fread(magic,1,8,file_) != 8 || memcmp(magic,NGOLOG_COMPRESSED_MAGIC,8) != 0)
+    {
+        fclose(file_);
+        throw NgoError(filename+" is not a compressed log file","NgoLogCompressedReader");
+    }
+    storedBytes_ = 8;
+}
+
+NgoLogCompressedReader::~NgoLogCompressedReader()
+{
+    fclose(file_);
+}
+
+void NgoLogCompressedReader::seek(unsigned long long offset)
+{
+    if (NGO_FSEEK64(file_,offset) != 0)
+        throw NgoError("Impossible to seek in "+filename_,"NgoLogCompressedReader::seek");
+}
+
+bool NgoLogCompressedReader::next(std::string & text)
+{
+    text.clear();
+    unsigned char raw[NGOLOG_BLOCK_HEADER_SIZE];
+    size_t n = fread(raw,1,sizeof(raw),file_);
+    if (n == 0)
+        return false;
+    if (n != sizeof(raw) || memcmp(raw,NGOLOG_BLOCK_MAGIC,4) != 0)
+        throw NgoError("Corrupted block header in "+filename_,"NgoLogCompressedReader::next");
+    NgoLogBlockHeader header;
+    memcpy(header.magic,raw,4);
+    header.rawSize = get32(raw+4);
+    header.storedSize = get32(raw+8);
+    header.checksum = get32(raw+12);
+
+    // a length byte stands for at most 255 bytes: a larger raw size is corrupted, and is not allocated
+    if ((header.rawSize != header.storedSize) && ((uint64_t)header.rawSize > (uint64_t)header.storedSize*255))
+        throw NgoError("Corrupted block header in "+filename_,"NgoLogCompressedReader::next");
+    // grown as the data are read, so that a corrupted stored size fails at the end of the file
+    size_t read = 0;
+    while (read < header.storedSize)
+    {
+        size_t chunk = header.storedSize-read;
+        const size_t step = read > 65536 ? read : 65536;
+        if (chunk > step)
+            chunk = step;
+        stored_.resize(read+chunk);
+        if (fread(&stored_[read],1,chunk,file_) != chunk)
+            throw NgoError("Truncated block in "+filename_,"NgoLogCompressedReader::next");
+        read += chunk;
+    }
+    if (stored_.empty())
+        stored_.resize(1);
+    storedBytes_ += sizeof(raw)+header.storedSize;
+
+    text.resize(header.rawSize);
+    if (header.storedSize == header.rawSize)
+        memcpy(&text[0],&stored_[0],header.rawSize);
+    else if (!NgoLogDecompress(&stored_[0],header.storedSize,&text[0],header.rawSize))
+        throw NgoError("Corrupted compressed block in "+filename_,"NgoLogCompressedReader::next");
+    if (fnv1a(text.data(),text.size()) != header.checksum)
+        throw NgoError("Checksum mismatch of a block in "+filename_,"NgoLogCompressedReader::next");
+    return true;
+}
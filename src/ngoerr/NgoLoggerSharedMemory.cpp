@@ -0,0 +1,272 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoLoggerSharedMemory.cpp
+@date October 2026
+@brief File containing the shared memory ring logger and its reader
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <string.h>
+#ifndef _WIN32
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
+#include "ngoerr/NgoLoggerSharedMemory.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+/*! @brief size reserved for the ring header, to keep the slots on their own cache lines */
+#define NGOLOG_SHM_HEADER_SIZE 64
+/*! @brief flag of a truncated record in NgoLogShmSlot::length */
+#define NGOLOG_SHM_TRUNCATED 0x80000000u
+
+static_assert(sizeof(NgoLogShmHeader) <= NGOLOG_SHM_HEADER_SIZE, "shared memory header too large");
+
+namespace
+{
+inline NgoLogShmSlot * slotAt(const NgoLogShmHeader * header, uint64_t slotCount, uint32_t slotSize,
+                              unsigned long long sequence)
+{
+    char * base = (char *)header + NGOLOG_SHM_HEADER_SIZE;
+    return (NgoLogShmSlot *)(base + (sequence % slotCount)*slotSize);
+}
+
+/*! @brief true if the header is initialised, with a geometry read consistently into slotCount and slotSize */
+inline bool readGeometry(const NgoLogShmHeader * header, uint64_t & slotCount, uint32_t & slotSize)
+{
+    if ((memcmp(header->magic,"NGOLOGSH",8) != 0) || (header->version != NGOLOG_SHM_VERSION))
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    slotCount = header->slotCount;
+    slotSize = header->slotSize;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // the magic is cleared by a writer while it changes the geometry
+    return memcmp(header->magic,"NGOLOGSH",8) == 0;
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoLoggerSharedMemory DEFINITION
+*******************************************************************************/
+NgoLoggerSharedMemory::NgoLoggerSharedMemory(std::string name, unsigned slotCount, unsigned slotSize,
+                                             TLogLevel reportingLevel, bool unlinkOnDestruction)
+:NgoLogger(reportingLevel,false),name_(name),header_(0L),mappedSize_(0),unlink_(unlinkOnDestruction)
+{
+#ifdef _WIN32
+    throw NgoErrorNoImpl("Shared memory logger is only available on POSIX systems","NgoLoggerSharedMemory");
+#else
+    if (slotCount == 0)
+        throw NgoErrorInvalidArgument(2,"The number of slots must be positive","NgoLoggerSharedMemory");
+    if ((slotSize % 8) || (slotSize <= sizeof(NgoLogShmSlot)))
+        throw NgoErrorInvalidArgument(3,"The slot size must be a multiple of 8 larger than the slot header","NgoLoggerSharedMemory");
+
+    int fd = shm_open(name_.c_str(),O_CREAT|O_RDWR,0644);
+    if (fd < 0)
+        throw NgoError("Impossible to create logger shared memory " + name_);
+    mappedSize_ = NGOLOG_SHM_HEADER_SIZE + (size_t)slotCount*slotSize;
+    // never shrunk: a reader of a previous ring would fault beyond the end of the object
+    struct stat st;
+    if ((fstat(fd,&st) != 0) || (((size_t)st.st_size < mappedSize_) && (ftruncate(fd,(off_t)mappedSize_) != 0)))
+    {
+        close(fd);
+        throw NgoError("Impossible to size logger shared memory " + name_);
+    }
+    void * address = mmap(0L,mappedSize_,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if (address == MAP_FAILED)
+        throw NgoError("Impossible to map logger shared memory " + name_);
+
+    header_ = (NgoLogShmHeader *)address;
+    // the content of a previous ring is discarded in place, the readers seeing no magic meanwhile
+    memset(header_->magic,0,8);
+    std::atomic_thread_fence(std::memory_order_release);
+    memset((char *)address + NGOLOG_SHM_HEADER_SIZE,0,mappedSize_ - NGOLOG_SHM_HEADER_SIZE);
+    header_->version = NGOLOG_SHM_VERSION;
+    header_->slotSize = slotSize;
+    header_->slotCount = slotCount;
+    header_->nextSequence.store(0,std::memory_order_relaxed);
+    // the magic is written last: a reader never sees a partially initialised header
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(header_->magic,"NGOLOGSH",8);
+    registerLogger();
+#endif
+}
+
+NgoLoggerSharedMemory::~NgoLoggerSharedMemory()
+{
+    unregisterLogger();
+#ifndef _WIN32
+    if (header_)
+        munmap(header_,mappedSize_);
+    if (unlink_)
+        shm_unlink(name_.c_str());
+#endif
+}
+
+void NgoLoggerSharedMemory::output(const TLogLevel level, std::string & log)
+{
+    if (level>reportingLevel_)
+        return;
+    uint64_t sequence = header_->nextSequence.fetch_add(1,std::memory_order_relaxed);
+    NgoLogShmSlot * slot = slotAt(header_,header_->slotCount,header_->slotSize,sequence);
+    slot->stamp.store(2*sequence+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t capacity = header_->slotSize - sizeof(NgoLogShmSlot);
+    uint32_t length = (uint32_t)log.size();
+    if (log.size() > capacity)
+        length = (uint32_t)capacity | NGOLOG_SHM_TRUNCATED;
+    slot->level = (uint32_t)level;
+    slot->length = length;
+    memcpy((char *)(slot+1),log.data(),length & ~NGOLOG_SHM_TRUNCATED);
+    slot->stamp.store(2*(sequence+1),std::memory_order_release);
+}
+
+void NgoLoggerSharedMemory::flush()
+{
+    // records are visible to readers as soon as they are written
+}
+
+/*******************************************************************************
+   CLASS NgoLogSharedMemoryReader DEFINITION
+*******************************************************************************/
+NgoLogSharedMemoryReader::NgoLogSharedMemoryReader(std::string name, bool fromNow)
+:name_(name),header_(0L),mappedSize_(0),slotCount_(0),slotSize_(0),expected_(0)
+{
+#ifdef _WIN32
+    throw NgoErrorNoImpl("Shared memory logger is only available on POSIX systems","NgoLogSharedMemoryReader");
+#else
+    remap();
+    unsigned long long next = header_->nextSequence.load(std::memory_order_acquire);
+    if (fromNow)
+        expected_ = next;
+    else
+        expected_ = next > slotCount_ ? next - slotCount_ : 0;
+#endif
+}
+
+void NgoLogSharedMemoryReader::remap()
+{
+#ifndef _WIN32
+    int fd = shm_open(name_.c_str(),O_RDONLY,0);
+    if (fd < 0)
+        throw NgoError("Impossible to open logger shared memory " + name_);
+    struct stat st;
+    if ((fstat(fd,&st) != 0) || ((size_t)st.st_size < NGOLOG_SHM_HEADER_SIZE))
+    {
+        close(fd);
+        throw NgoError("Logger shared memory " + name_ + " is not initialised");
+    }
+    const size_t size = (size_t)st.st_size;
+    void * address = mmap(0L,size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if (address == MAP_FAILED)
+        throw NgoError("Impossible to map logger shared memory " + name_);
+    uint64_t slotCount = 0;
+    uint32_t slotSize = 0;
+    if (!readGeometry((const NgoLogShmHeader *)address,slotCount,slotSize)
+      ||(slotCount == 0) || (slotSize <= sizeof(NgoLogShmSlot))
+      ||(slotCount > (size - NGOLOG_SHM_HEADER_SIZE)/slotSize))
+    {
+        munmap(address,size);
+        throw NgoError("Logger shared memory " + name_ + " has an unknown layout");
+    }
+    if (header_)
+        munmap((void *)header_,mappedSize_);
+    header_ = (const NgoLogShmHeader *)address;
+    mappedSize_ = size;
+    slotCount_ = slotCount;
+    slotSize_ = slotSize;
+#endif
+}
+
+NgoLogSharedMemoryReader::~NgoLogSharedMemoryReader()
+{
+#ifndef _WIN32
+    if (header_)
+        munmap((void *)header_,mappedSize_);
+#endif
+}
+
+bool NgoLogSharedMemoryReader::next(Record & record)
+{
+    unsigned long long lost = 0;
+    for (;;)
+    {
+        uint64_t slotCount;
+        uint32_t slotSize;
+        if (!readGeometry(header_,slotCount,slotSize))
+            return false; // being created again
+        if ((slotCount != slotCount_) || (slotSize != slotSize_))
+        {
+            // created again with another geometry: the slots are only addressed within the mapping
+            remap();
+            expected_ = 0;
+            continue;
+        }
+        unsigned long long head = header_->nextSequence.load(std::memory_order_acquire);
+        if (head < expected_)
+        {
+            // the ring has been recreated by a new writer
+            expected_ = 0;
+            continue;
+        }
+        if (head == expected_)
+            return false;
+        if (head - expected_ > slotCount_)
+        {
+            lost += head - slotCount_ - expected_;
+            expected_ = head - slotCount_;
+        }
+
+        const NgoLogShmSlot * slot = slotAt(header_,slotCount_,slotSize_,expected_);
+        unsigned long long stamp = slot->stamp.load(std::memory_order_acquire);
+        unsigned long long complete = 2*(expected_+1);
+        if (stamp < complete)
+            return false; // still being written
+        if (stamp > complete)
+        {
+            // already overwritten by a newer record
+            lost++;
+            expected_++;
+            continue;
+        }
+        uint32_t length = slot->length;
+        record.level = (TLogLevel)slot->level;
+        record.truncated = (length & NGOLOG_SHM_TRUNCATED) != 0;
+        length &= ~NGOLOG_SHM_TRUNCATED;
+        size_t capacity = slotSize_ - sizeof(NgoLogShmSlot);
+        record.text.assign((const char *)(slot+1),length < capacity ? length : capacity);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->stamp.load(std::memory_order_relaxed) != stamp)
+        {
+            lost++;
+            expected_++;
+            continue;
+        }
+        record.sequence = expected_;
+        record.lost = lost;
+        expected_++;
+        return true;
+    }
+}
@@ -29,10 +29,18 @@
 /*******************************************************************************
    INCLUDES
 *******************************************************************************/
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <locale>
 #include <string>
 
 #include "ngoerr/NgoLogging.h"
+#include "ngoerr/NgoCrashHandler.h"
+#include "ngoerr/NgoLogConfig.h"
+#include "ngoerr/NgoLogIndex.h"
+#include "ngoerr/NgoScopeTimer.h"
 /*******************************************************************************
    DEFINES / TYPDEFS / ENUMS
 *******************************************************************************/
@@ -40,13 +48,92 @@
 /*******************************************************************************
    GLOBAL VARIABLES
 *******************************************************************************/
+static const char* const levelNames[] = {"ERROR", "WARNING", "INFO", "DEBUG", "DEBUG1", "DEBUG2", "DEBUG3", "DEBUG4"};
+
+/*! @brief capacity reserved for the record buffer of a thread */
+static const size_t recordCapacity = 512;
+
+namespace
+{
+    /*! @brief gives the record buffer of the calling thread
+    The buffer keeps its capacity from one log to the next. A log emitted while the buffer is
+    in use (by a logger output for instance) gets its own local buffer. */
+    class NgoLogRecordBuffer
+    {
+    public:
+        NgoLogRecordBuffer() : nested_(inUse()) { inUse() = true; }
+        ~NgoLogRecordBuffer() { if (!nested_) inUse() = false; }
+        /*! @brief returns the empty buffer, starting with the prefix of the level */
+        std::string & start(TLogLevel level)
+        {
+            std::string & record = nested_ ? local_ : shared();
+            record.clear();
+            if (record.capacity() < recordCapacity)
+                record.reserve(recordCapacity);
+            record += levelNames[level];
+            record += "\t: ";
+            return record;
+        }
+    private:
+        static bool & inUse() { static thread_local bool used = false; return used; }
+        static std::string & shared() { static thread_local std::string buffer; return buffer; }
+        bool nested_;
+        std::string local_;
+    };
+
+    /*! @brief true if the stream formats the doubles as NgoLog sets it: scientific, no width nor flags */
+    inline bool formatsLikeLog(const std::ios_base & str)
+    {
+        const std::ios_base::fmtflags flags = str.flags()
+            & (std::ios_base::floatfield | std::ios_base::showpos | std::ios_base::uppercase | std::ios_base::showpoint);
+        return flags == std::ios_base::scientific && str.width() == 0
+            && str.precision() >= 0 && str.precision() <= 100;
+    }
+
+    /*! @brief longest double formatted by formatsLikeLog streams: sign, digit, point, 100 digits, exponent */
+    const size_t doubleCapacity = 112;
+
+    /*! @brief writes a double as printf("%.*e") would, without locale */
+    inline char * formatDouble(char * first, char * last, double value, const std::ios_base & str)
+    {
+        return std::to_chars(first,last,value,std::chars_format::scientific,(int)str.precision()).ptr;
+    }
+
+    /*! @brief facet of the NgoLog streams, formatting their doubles with std::to_chars
+    The text is the one of the default facet in the classic locale, the other cases are left to it. */
+    class NgoLogNumPut : public std::num_put<char>
+    {
+    protected:
+        virtual iter_type do_put(iter_type out, std::ios_base & str, char fill, double value) const
+        {
+            if (!formatsLikeLog(str))
+                return std::num_put<char>::do_put(out,str,fill,value);
+            char buffer[doubleCapacity];
+            return std::copy(buffer,formatDouble(buffer,buffer+sizeof(buffer),value,str),out);
+        }
+    };
+
+    /*! @brief locale of the NgoLog streams, never freed as logs may be written by static destructors */
+    const std::locale & logLocale()
+    {
+        static const std::locale * locale = new std::locale(std::locale::classic(),new NgoLogNumPut());
+        return *locale;
+    }
+
+    /*! @brief log output by a logger once there is room again after dropping logs */
+    std::string droppedNotice(unsigned long long dropped)
+    {
+        return std::string(levelNames[logWARNING]) + "\t: " + std::to_string(dropped) + " records dropped\n";
+    }
+}
 
 /*******************************************************************************
    CLASS NgoLog DEFINITION
 *******************************************************************************/
 NgoLog::NgoLog(TLogLevel level,bool unique)
-:level_(level),unique_(unique)
+:level_(level),unique_(unique),code_(E_OK)
 {
+    os.imbue(logLocale());
     os.setf(std::ios::scientific,std::ios::floatfield);
     os.precision(5);
     os << NgoLoggerManager::get()->toString(level) << "\t: ";
@@ -59,39 +146,138 @@ NgoLog::~NgoLog()
     std::string os_str = os.str();
     if (!unique_)
         //NgoLoggerManager::get()->addLog(level_,os.str());
-        NgoLoggerManager::get()->addLog(level_, os_str);
+        NgoLoggerManager::get()->addLog(level_, os_str, code_);
     else
         //NgoLoggerManager::get()->addUniqueLog(level_,os.str());
-        NgoLoggerManager::get()->addUniqueLog(level_, os_str);
+        NgoLoggerManager::get()->addUniqueLog(level_, os_str, code_);
+}
+/*******************************************************************************
+   CLASS NgoLogArray DEFINITION
+*******************************************************************************/
+std::ostream & operator <<(std::ostream & os, const NgoLogArray & array)
+{
+    if (!formatsLikeLog(os))
+    {
+        for (size_t i=0;i<array.size_;i++)
+        {
+            if (i)
+                os << array.separator_;
+            os << array.values_[i];
+        }
+        return os;
+    }
+    // formatted into a local buffer, written to the stream when full
+    const size_t separatorLength = strlen(array.separator_);
+    char buffer[1024];
+    size_t used = 0;
+    for (size_t i=0;i<array.size_;i++)
+    {
+        if (i)
+        {
+            if (used+separatorLength > sizeof(buffer))
+            {
+                os.write(buffer,used);
+                used = 0;
+            }
+            if (separatorLength > sizeof(buffer))
+                os.write(array.separator_,separatorLength);
+            else
+            {
+                memcpy(buffer+used,array.separator_,separatorLength);
+                used += separatorLength;
+            }
+        }
+        if (used+doubleCapacity > sizeof(buffer))
+        {
+            os.write(buffer,used);
+            used = 0;
+        }
+        used = formatDouble(buffer+used,buffer+sizeof(buffer),array.values_[i],os)-buffer;
+    }
+    os.write(buffer,used);
+    return os;
 }
+
 /*******************************************************************************
    CLASS NgoLogger DEFINITION
 *******************************************************************************/
 NgoLogger::NgoLogger(TLogLevel reportingLevel)
-:reportingLevel_(reportingLevel)
+:reportingLevel_(reportingLevel),backpressure_(logBLOCK),capacity_(0),keepLevel_(logWARNING),dropped_(0),
+configured_(false),codeLevel_(reportingLevel)
 {
-    NgoLoggerManager::get()->loggers_.push_back(this);
+    NgoLoggerManager::get()->registerLogger(this);
 };
 
-#include <algorithm>
+NgoLogger::NgoLogger(TLogLevel reportingLevel, bool autoRegister)
+:reportingLevel_(reportingLevel),backpressure_(logBLOCK),capacity_(0),keepLevel_(logWARNING),dropped_(0),
+configured_(false),codeLevel_(reportingLevel)
+{
+    if (autoRegister)
+        registerLogger();
+};
 
 NgoLogger::~NgoLogger()
 {
-    std::vector<NgoLogger *> & loggers = NgoLoggerManager::get()->loggers_;
-    std::vector<NgoLogger *>::iterator it = std::find(loggers.begin(),loggers.end(),this);
-    loggers.erase(it);
+    unregisterLogger();
 };
+
+void NgoLogger::setReportingLevel(TLogLevel reportingLevel)
+{
+    NgoLoggerManager * manager = NgoLoggerManager::get();
+    std::lock_guard<std::recursive_mutex> lock(manager->mutex());
+    reportingLevel_ = reportingLevel;
+    configured_ = false;
+    manager->updateReportingLevel();
+}
+
+void NgoLogger::setName(const std::string & name)
+{
+    NgoLoggerManager * manager = NgoLoggerManager::get();
+    std::lock_guard<std::recursive_mutex> lock(manager->mutex());
+    name_ = name;
+    NgoLogConfig::apply(this);
+    manager->updateReportingLevel();
+}
+
+void NgoLogger::setBackpressure(TLogBackpressure policy, size_t capacity, TLogLevel keepLevel)
+{
+    // not under the manager lock, which a dispatch waiting for room holds
+    backpressure_.store(policy,std::memory_order_relaxed);
+    keepLevel_.store(keepLevel,std::memory_order_relaxed);
+    capacity_.store(capacity,std::memory_order_relaxed);
+}
+
+void NgoLogger::registerLogger()
+{
+    NgoLoggerManager::get()->registerLogger(this);
+}
+
+void NgoLogger::unregisterLogger()
+{
+    NgoLoggerManager::get()->unregisterLogger(this);
+}
 /*******************************************************************************
    CLASS NgoLoggerFile DEFINITION
 *******************************************************************************/
 NgoLoggerFile::NgoLoggerFile(FILE* pFile,TLogLevel reportingLevel)
-:NgoLogger(reportingLevel),pFile_(pFile)
-{}
+:NgoLogger(reportingLevel,false),pFile_(pFile)
+{
+    registerLogger();
+}
+
+NgoLoggerFile::NgoLoggerFile(FILE* pFile,TLogLevel reportingLevel,bool autoRegister)
+:NgoLogger(reportingLevel,false),pFile_(pFile)
+{
+    if (autoRegister)
+        registerLogger();
+}
 
 NgoLoggerFile::~NgoLoggerFile()
 {
+    unregisterLogger();
+    // the FILE is owned by the caller, it may be stdout or stderr
     if (pFile_)
-        fclose(pFile_);
+        fflush(pFile_);
 }
 
 void NgoLoggerFile::output(const TLogLevel level, std::string & log)
@@ -111,59 +297,125 @@ void NgoLoggerFile::flush()
 /*******************************************************************************
    CLASS NgoLoggerFilename DEFINITION
 *******************************************************************************/
-NgoLoggerFilename::NgoLoggerFilename(std::string filename,std::string openingMode, TLogLevel reportingLevel)
-:NgoLoggerFile(0L,reportingLevel),filename_(filename)
+NgoLoggerFilename::NgoLoggerFilename(std::string filename,std::string openingMode, TLogLevel reportingLevel, bool index)
+:NgoLoggerFile(0L,reportingLevel,false),filename_(filename),index_(0L),offset_(0)
 {
    pFile_ = fopen(filename.c_str(),openingMode.c_str());
    if (!pFile_)
       throw NgoError("Impossible to create logger file");
+   if (index)
+   {
+      fseek(pFile_,0,SEEK_END);
+#ifdef _WIN32
+      offset_ = (unsigned long long)_ftelli64(pFile_);
+#else
+      offset_ = (unsigned long long)ftello(pFile_);
+#endif
+      try
+      {
+         index_ = new NgoLogIndexWriter(filename + NGOLOG_INDEX_SUFFIX,openingMode[0] == 'a');
+      }
+      catch (...)
+      {
+         fclose(pFile_);
+         throw;
+      }
+   }
    fclose(pFile_);
    pFile_ = 0L;
+   registerLogger();
 }
 
 NgoLoggerFilename::~NgoLoggerFilename()
 {
+    unregisterLogger();
     if (pFile_)
         fclose(pFile_);
+    pFile_ = 0L;
+    delete index_;
 }
 
 void NgoLoggerFilename::output(const TLogLevel level, std::string & log)
 {
    if (level>reportingLevel_)
        return;
+   // binary when indexed, so that the offsets of the index are offsets in the file
    if (!pFile_)
-       pFile_ = fopen(filename_.c_str(),"a");
+       pFile_ = fopen(filename_.c_str(),index_ ? "ab" : "a");
    if (!pFile_)
        throw NgoError("Impossible to open logger file");
 
    fputs(log.c_str(),pFile_);
+   if (!index_)
+       return;
+   NgoLogIndexEntry entry;
+   entry.offset = offset_;
+   entry.block = 0;
+   entry.time = NgoLogIndexTime();
+   entry.length = (uint32_t)log.size();
+   entry.code = (int16_t)NgoLoggerManager::get()->recordCode();
+   entry.level = (int8_t)level;
+   entry.flags = 0;
+   index_->add(entry);
+   offset_ += log.size();
 }
 
 void NgoLoggerFilename::flush()
 {
     if (pFile_)
-        fflush(pFile_);
-    fclose(pFile_);
+        fclose(pFile_);
     pFile_ = 0L;
+    // after the records, so that an entry never points after the end of the file
+    if (index_)
+        index_->flush();
 }
 
 /*******************************************************************************
    CLASS NgoLoggerBufferedString DEFINITION
 *******************************************************************************/
 NgoLoggerBufferedString::NgoLoggerBufferedString(TLogLevel reportingLevel)
-:NgoLogger(reportingLevel)
+:NgoLogger(reportingLevel,false),first_(0),start_(0),droppedPending_(0)
 {
+    registerLogger();
 }
 
 NgoLoggerBufferedString::~NgoLoggerBufferedString()
 {
+    unregisterLogger();
 }
 
 void NgoLoggerBufferedString::output(const TLogLevel level, std::string & log)
 {
    if (level>reportingLevel_)
        return;
+   std::lock_guard<std::mutex> lock(mutex_);
+   const size_t capacity = capacity_.load(std::memory_order_relaxed);
+   if (capacity && lengths_.size()-first_ >= capacity)
+   {
+       const TLogBackpressure policy = backpressure_.load(std::memory_order_relaxed);
+       if (policy == logDROP_NEWEST
+           || (policy == logDROP_BELOW_LEVEL && level > keepLevel_.load(std::memory_order_relaxed)))
+       {
+           dropped_.fetch_add(1,std::memory_order_relaxed);
+           droppedPending_++;
+           return;
+       }
+       if (policy == logDROP_OLDEST)
+       {
+           start_ += lengths_[first_++];
+           dropped_.fetch_add(1,std::memory_order_relaxed);
+           droppedPending_++;
+           // the logs dropped are erased once they are as many as the logs kept
+           if (first_ >= capacity)
+           {
+               buffer_.erase(0,start_);
+               lengths_.erase(lengths_.begin(),lengths_.begin()+first_);
+               first_ = start_ = 0;
+           }
+       }
+   }
    buffer_ += log;
+   lengths_.push_back(log.size());
 }
 
 void NgoLoggerBufferedString::flush()
@@ -171,59 +423,469 @@ void NgoLoggerBufferedString::flush()
     // we should do nothing, as in fact, we want to flush when buffered message is required
 }
 
-static std::string returnedBuffer;
 const char * NgoLoggerBufferedString::getBufferedMessage()
 {
-    returnedBuffer = buffer_;
+    static thread_local std::string returnedBuffer;
+    NgoLoggerManager * manager = NgoLoggerManager::get();
+    {
+        std::lock_guard<std::recursive_mutex> lock(manager->mutex());
+        manager->drainThreadBuffers();
+    }
+    manager->waitForWorker(this);
+    std::lock_guard<std::mutex> lock(mutex_);
+    returnedBuffer.swap(buffer_);
+    returnedBuffer.erase(0,start_);
     buffer_.clear();
+    lengths_.clear();
+    first_ = start_ = 0;
+    // the reader has made room
+    if (droppedPending_)
+        returnedBuffer += droppedNotice(droppedPending_);
+    droppedPending_ = 0;
     return returnedBuffer.c_str();
 }
 
 /*******************************************************************************
    CLASS NgoLoggerManager DEFINITION
 *******************************************************************************/
-NgoLoggerManager * NgoLoggerManager::instance_ = 0L;
-NgoLoggerBufferedString * NgoLoggerManager::buffered = 0L;
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    /*! @brief code attached to the log being output by the thread */
+    thread_local int currentCode = E_OK;
+
+    /*! @brief a log appended to a thread buffer, its text is stored in the text of the buffer */
+    struct NgoLogBufferedRecord
+    {
+        unsigned long long sequence;
+        TLogLevel level;
+        int code;
+        size_t offset;
+        size_t length;
+    };
+
+    /*! @brief logs of a thread. Its lock is only shared with the merge, so appending is not contended */
+    struct alignas(64) NgoLogThreadBuffer
+    {
+        NgoLogThreadBuffer() : orphan(false) {};
+        std::mutex mutex;
+        std::vector<NgoLogBufferedRecord> records;
+        std::string text;
+        /*! @brief set when the thread has exited, the buffer is deleted by the next merge */
+        bool orphan;
+    };
+
+    /*! @brief logs sorted by sequence, input of the merge */
+    struct NgoLogRun
+    {
+        std::vector<NgoLogBufferedRecord> records;
+        std::string text;
+        size_t next;
+    };
+
+    /*! @brief gives its buffer to a thread, and orphans it when the thread exits */
+    struct NgoLogThreadBufferHandle
+    {
+        NgoLogThreadBufferHandle() : buffer(0L), buffersMutex(0L) {};
+        ~NgoLogThreadBufferHandle()
+        {
+            if (!buffer)
+                return;
+            std::lock_guard<std::mutex> lock(*buffersMutex);
+            buffer->orphan = true;
+        }
+        NgoLogThreadBuffer * buffer;
+        std::mutex * buffersMutex;
+    };
+}
+
+/*! @brief queue of the logs of a logger, output in order by its own thread */
+struct NgoLoggerWorker
+{
+    struct Record
+    {
+        TLogLevel level;
+        int code;
+        std::string text;
+    };
+
+    NgoLoggerWorker(NgoLogger * logger)
+    :logger_(logger),first_(0),nPending_(0),dropped_(0),blocked_(0),flushRequested_(0),flushed_(0),
+    stop_(false),waiting_(false)
+    {
+        thread_ = std::thread(&NgoLoggerWorker::run,this);
+    }
+    ~NgoLoggerWorker()
+    {
+        stop();
+    }
+    /*! @brief appends a log, called by the dispatch, following the backpressure policy of the logger */
+    void push(TLogLevel level, const std::string & log, int code)
+    {
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (full())
+            {
+                switch (logger_->backpressure_.load(std::memory_order_relaxed))
+                {
+                case logBLOCK:
+                    blocked_++;
+                    room_.wait(lock,[&]{return !full();});
+                    blocked_--;
+                    break;
+                case logDROP_NEWEST:
+                    drop();
+                    return;
+                case logDROP_OLDEST:
+                    first_++;
+                    drop();
+                    // the slots dropped are moved to the end once they are as many as the logs kept
+                    if (first_ >= nPending_-first_)
+                    {
+                        std::rotate(pending_.begin(),pending_.begin()+first_,pending_.begin()+nPending_);
+                        nPending_ -= first_;
+                        first_ = 0;
+                    }
+                    break;
+                case logDROP_BELOW_LEVEL:
+                    if (level > logger_->keepLevel_.load(std::memory_order_relaxed))
+                    {
+                        drop();
+                        return;
+                    }
+                    break;
+                }
+            }
+            // the records keep their capacity, so a queue in use does not allocate
+            if (nPending_ == pending_.size())
+                pending_.push_back(Record());
+            Record & record = pending_[nPending_++];
+            record.level = level;
+            record.code = code;
+            record.text.assign(log);
+            // a busy worker finds the record when it takes its next batch
+            wake = waiting_;
+        }
+        if (wake)
+            ready_.notify_one();
+    }
+    /*! @brief asks to flush the logger once the logs appended so far are output */
+    /*! @return ticket to wait for */
+    unsigned long long requestFlush()
+    {
+        unsigned long long ticket;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ticket = ++flushRequested_;
+        }
+        ready_.notify_one();
+        return ticket;
+    }
+    void waitFlushed(unsigned long long ticket)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock,[&]{return flushed_ >= ticket;});
+    }
+    /*! @brief outputs the logs appended and joins the thread */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable())
+                return;
+            stop_ = true;
+        }
+        ready_.notify_one();
+        thread_.join();
+    }
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            while (!nPending_ && flushRequested_ <= flushed_ && !stop_)
+            {
+                waiting_ = true;
+                ready_.wait(lock);
+                waiting_ = false;
+            }
+            // the records appended before a request are in this batch or in a previous one
+            batch_.swap(pending_);
+            const size_t first = first_;
+            const size_t n = nPending_;
+            first_ = nPending_ = 0;
+            const unsigned long long flushRequested = flushRequested_;
+            const bool stop = stop_;
+            // dropped while the records of the batch were waiting: told after them
+            const unsigned long long dropped = dropped_;
+            dropped_ = 0;
+            if (blocked_)
+                room_.notify_all();
+            lock.unlock();
+            for (size_t i=first;i<n;i++)
+                output(batch_[i]);
+            if (dropped)
+            {
+                Record notice;
+                notice.level = logWARNING;
+                notice.code = E_OK;
+                notice.text = droppedNotice(dropped);
+                output(notice);
+            }
+            if (flushRequested > flushed_)
+                flush();
+            lock.lock();
+            flushed_ = flushRequested;
+            done_.notify_all();
+            if (stop && !nPending_)
+                break;
+        }
+        // waiters of a flush requested after the stop are not left waiting
+        flushed_ = flushRequested_;
+        done_.notify_all();
+    }
+    bool full() const
+    {
+        const size_t capacity = logger_->capacity_.load(std::memory_order_relaxed);
+        return capacity && nPending_-first_ >= capacity;
+    }
+    void drop()
+    {
+        logger_->dropped_.fetch_add(1,std::memory_order_relaxed);
+        dropped_++;
+    }
+    void output(Record & record)
+    {
+        currentCode = record.code;
+        // no caller to report to: the error goes to stderr and the worker goes on
+        try
+        {
+            logger_->output(record.level,record.text);
+        }
+        catch (std::exception & e)
+        {
+            fprintf(stderr,"Log output failed: %s\n",e.what());
+        }
+        catch (...)
+        {
+            // a logger may raise anything, and an exception leaving the thread would terminate
+            fprintf(stderr,"Log output failed: unknown exception\n");
+        }
+        currentCode = E_OK;
+    }
+    void flush()
+    {
+        try
+        {
+            logger_->flush();
+        }
+        catch (std::exception & e)
+        {
+            fprintf(stderr,"Log flush failed: %s\n",e.what());
+        }
+        catch (...)
+        {
+            // a logger may raise anything, and an exception leaving the thread would terminate
+            fprintf(stderr,"Log flush failed: unknown exception\n");
+        }
+    }
 
-NgoLoggerManager::NgoLoggerManager() 
+    NgoLogger * logger_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable done_;
+    /*! @brief signaled when the thread takes the queue, to the dispatches waiting for room */
+    std::condition_variable room_;
+    /*! @brief records appended, the ones from first_ to nPending_ are waiting */
+    std::vector<Record> pending_;
+    size_t first_;
+    size_t nPending_;
+    /*! @brief records dropped since the last notice */
+    unsigned long long dropped_;
+    /*! @brief number of dispatches waiting for room */
+    int blocked_;
+    /*! @brief records being output, only used by the thread */
+    std::vector<Record> batch_;
+    unsigned long long flushRequested_;
+    unsigned long long flushed_;
+    bool stop_;
+    /*! @brief true while the thread waits for records */
+    bool waiting_;
+};
+
+struct NgoLogRepeatTimer
 {
+    NgoLogRepeatTimer() : armed(false), stop(false) {};
+    std::thread thread;
+    /*! @brief lock of the fields below, taken after the manager lock */
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::chrono::steady_clock::time_point deadline;
+    /*! @brief true once repeats are counted, until the deadline is reached */
+    bool armed;
+    bool stop;
 };
 
-NgoLoggerManager::~NgoLoggerManager()
+struct NgoLoggerManager::State
 {
-    for (int i=loggers_.size()-1;i>=0;i--)
-        delete loggers_[i];
-	buffered = 0L;
+    State() : buffered(0L), sinkWorkers(false), coalescing(false), lastHash(0), lastLevel(logERROR),
+              lastCode(E_OK), repeats(0), sequence(0), draining(false) {};
+    std::recursive_mutex mutex;
+    std::vector<NgoLogger *> loggers;
+    std::vector<std::string> uniqueLogs;
+    /*! @brief default buffered logger registered by init */
+    NgoLoggerBufferedString * buffered;
+    /*! @brief true if the loggers registered get a worker */
+    bool sinkWorkers;
+
+    /*! @brief true if the repeated logs are counted, the fields below describe the last log dispatched */
+    bool coalescing;
+    std::chrono::steady_clock::duration repeatTimeout;
+    std::shared_ptr<NgoLogRepeatTimer> repeatTimer;
+    std::string lastLog;
+    size_t lastHash;
+    TLogLevel lastLevel;
+    int lastCode;
+    /*! @brief repeats of the last log counted since it was dispatched or the repeats reported */
+    unsigned long long repeats;
+    std::chrono::steady_clock::time_point firstRepeat;
+
+    /*! @brief sequence number of the next buffered log, on its own cache line */
+    alignas(64) std::atomic<unsigned long long> sequence;
+    /*! @brief lock of the list of thread buffers */
+    alignas(64) std::mutex buffersMutex;
+    std::vector<NgoLogThreadBuffer *> buffers;
+    /*! @brief merge state, protected by mutex and kept to reuse its capacity */
+    std::vector<NgoLogRun> runs;
+    std::vector<std::pair<unsigned long long,size_t> > heap;
+    /*! @brief logs stamped after the start of a merge, dispatched by the next one */
+    NgoLogRun carry;
+    std::string line;
+    bool draining;
 };
 
-NgoLoggerManager * NgoLoggerManager::get()
+// constant initialised: no constructor runs at load time and no destructor at exit
+NgoLoggerManager NgoLoggerManager::instance_;
+std::atomic<int> NgoLoggerManager::enabledLevel_(logDEBUG4);
+
+NgoLoggerManager::State & NgoLoggerManager::state()
+{
+    State * state = state_.load(std::memory_order_acquire);
+    if (state)
+        return *state;
+    State * created = new State();
+    if (!state_.compare_exchange_strong(state,created,std::memory_order_acq_rel,std::memory_order_acquire))
+    {
+        delete created;
+        return *state;
+    }
+    return *created;
+}
+
+NgoLoggerManager::State & NgoLoggerManager::started()
+{
+    if (phase_.load(std::memory_order_acquire) == UNINITIALISED)
+        start(true);
+    return state();
+}
+
+std::recursive_mutex & NgoLoggerManager::mutex()
+{
+    return state().mutex;
+}
+
+std::vector<NgoLogger *> & NgoLoggerManager::loggers()
 {
-    if (0L == instance_) {
-		instance_ = new NgoLoggerManager();
+    return state().loggers;
+}
+
+void NgoLoggerManager::start(bool implicit)
+{
+    State & s = state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    const int phase = phase_.load(std::memory_order_relaxed);
+    if (phase == RUNNING || (implicit && phase == SHUT_DOWN))
+        return;
+    phase_.store(RUNNING,std::memory_order_release);
+    updateReportingLevel();
 #ifdef _DEBUG
-		//NgoLoggerFile * logstderr = new NgoLoggerFile(stderr);
-		buffered = new NgoLoggerBufferedString();
+    s.buffered = new NgoLoggerBufferedString();
 #else
-		//NgoLoggerFile * logstderr = new NgoLoggerFile(stderr,logINFO);
-		buffered = new NgoLoggerBufferedString(logINFO);
+    s.buffered = new NgoLoggerBufferedString(logINFO);
 #endif
-	}
-    return instance_;
+    // levels given by the environment
+    try
+    {
+        NgoLogConfig::reload();
+    }
+    catch (NgoError & er)
+    {
+        NGOLOG(logWARNING) << er.getDescription();
+    }
 }
 
-void NgoLoggerManager::kill() 
+void NgoLoggerManager::stop(Phase next)
 {
-    if (instance_ != 0L)
+    // before locking: the watch of the configuration file and the reports of the timers lock the manager
+    NgoLogConfig::reset();
+    NgoTimer::stopReporting();
+    State & s = state();
+    std::vector<NgoLogger *> loggers;
+    std::vector<std::shared_ptr<NgoLoggerWorker> > workers;
+    std::shared_ptr<NgoLogRepeatTimer> repeatTimer;
     {
-        delete instance_;
-        instance_ = 0L;
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        drainThreadBuffers();
+        bufferCapacity_.store(0,std::memory_order_relaxed);
+        repeatTimer = stopRepeatCoalescing(s);
+        loggers.swap(s.loggers);
+        s.sinkWorkers = false;
+        for (size_t i=0;i<loggers.size();i++)
+            if (loggers[i]->worker_)
+                workers.push_back(std::move(loggers[i]->worker_));
     }
+    // joined without the lock, a logger may log from its output and the timer takes the lock
+    if (repeatTimer)
+        repeatTimer->thread.join();
+    for (size_t i=0;i<workers.size();i++)
+        workers[i]->stop();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    for (size_t i=0;i<loggers.size();i++)
+        loggers[i]->flush();
+    for (int i=loggers.size()-1;i>=0;i--)
+        delete loggers[i];
+    std::vector<std::string>().swap(s.uniqueLogs);
+    s.buffered = 0L;
+    phase_.store(next,std::memory_order_release);
+    enabledLevel_.store(next == SHUT_DOWN ? logWARNING : logDEBUG4,std::memory_order_relaxed);
+}
+
+void NgoLoggerManager::init()
+{
+    instance_.start(false);
+}
+
+void NgoLoggerManager::shutdown()
+{
+    instance_.stop(SHUT_DOWN);
+}
+
+void NgoLoggerManager::kill() 
+{
+    instance_.stop(UNINITIALISED);
 }
 
 std::string NgoLoggerManager::toString(TLogLevel level)
 {
-	static const char* const buffer[] = {"ERROR", "WARNING", "INFO", "DEBUG", "DEBUG1", "DEBUG2", "DEBUG3", "DEBUG4"};
-    return buffer[level];
+    return levelNames[level];
 }
 
 TLogLevel NgoLoggerManager::fromString(const std::string& level)
@@ -248,64 +910,559 @@ TLogLevel NgoLoggerManager::fromString(const std::string& level)
     return logINFO;
 }
 
+void NgoLoggerManager::registerLogger(NgoLogger * logger)
+{
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    if (phase_.load(std::memory_order_relaxed) == SHUT_DOWN)
+        return;
+    // the logs emitted before the registration must not reach the logger
+    drainThreadBuffers();
+    s.loggers.push_back(logger);
+    if (s.sinkWorkers && !logger->worker_)
+        logger->worker_ = std::make_shared<NgoLoggerWorker>(logger);
+    NgoLogConfig::apply(logger);
+    updateReportingLevel();
+}
+
+void NgoLoggerManager::unregisterLogger(NgoLogger * logger)
+{
+    State & s = state();
+    std::shared_ptr<NgoLoggerWorker> worker;
+    {
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        // the logs emitted while the logger was registered must reach it
+        drainThreadBuffers();
+        std::vector<NgoLogger *>::iterator it = std::find(s.loggers.begin(),s.loggers.end(),logger);
+        if (it != s.loggers.end())
+            s.loggers.erase(it);
+        if (logger == s.buffered)
+            s.buffered = 0L;
+        updateReportingLevel();
+        worker.swap(logger->worker_);
+    }
+    // no log is dispatched to the logger any more: its queue is output without the lock
+    if (worker)
+        worker->stop();
+}
+
 std::vector<NgoLogger *> NgoLoggerManager::getLoggers()
 {
-    return loggers_;
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    return s.loggers;
 }
 
 NgoLoggerBufferedString * NgoLoggerManager::getBufferedLogger()
 {
-	return buffered;
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+	return s.buffered;
 }
 
 
 TLogLevel NgoLoggerManager::reportingLevel()
 {
+    started();
+    return computeReportingLevel();
+}
+
+void NgoLoggerManager::updateReportingLevel()
+{
+    computeReportingLevel();
+}
+
+TLogLevel NgoLoggerManager::computeReportingLevel()
+{
+    State & s = state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
     TLogLevel ret = logERROR;
-    for (int i=0;i<loggers_.size();i++)
-        if (loggers_[i]->reportingLevel() > ret) 
-            ret = loggers_[i]->reportingLevel();
+    switch (phase_.load(std::memory_order_relaxed))
+    {
+    case UNINITIALISED:
+        // let the next log through, it initialises the manager
+        ret = logDEBUG4;
+        break;
+    case SHUT_DOWN:
+        ret = logWARNING;
+        break;
+    default:
+        for (size_t i=0;i<s.loggers.size();i++)
+            if (s.loggers[i]->reportingLevel() > ret) 
+                ret = s.loggers[i]->reportingLevel();
+    }
+    enabledLevel_.store(ret,std::memory_order_relaxed);
     return ret;
 }
 
-void NgoLoggerManager::addUniqueLog(TLogLevel level, std::string & log)
+void NgoLoggerManager::addUniqueLog(TLogLevel level, std::string & log, int code)
 {
-    for (int i=0;i<uniqueLogs_.size();i++)
-        if (log==uniqueLogs_[i])
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    for (size_t i=0;i<s.uniqueLogs.size();i++)
+        if (log==s.uniqueLogs[i])
             return;
-    addLog(level,log);
-    uniqueLogs_.push_back(log);
+    addLog(level,log,code);
+    s.uniqueLogs.push_back(log);
 }
 
-void NgoLoggerManager::addLog(TLogLevel level, std::string & log)
+void NgoLoggerManager::addLog(TLogLevel level, std::string & log, int code)
 {
-    if (loggers_.empty())
-        new NgoLoggerFile(stderr);
-    for (int i=0;i<loggers_.size();i++)
-        loggers_[i]->output(level,log);
+    State & s = started();
+    if (bufferCapacity_.load(std::memory_order_relaxed) && phase_.load(std::memory_order_relaxed) == RUNNING)
+    {
+        appendToThreadBuffer(s,level,log,code);
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    dispatch(s,level,log,code);
+}
+
+int NgoLoggerManager::recordCode()
+{
+    return currentCode;
+}
+
+void NgoLoggerManager::dispatch(State & s, TLogLevel level, std::string & log, int code, bool crashRecorded)
+{
+    if (s.coalescing)
+    {
+        const size_t hash = std::hash<std::string>()(log);
+        if (hash == s.lastHash && level == s.lastLevel && code == s.lastCode && log == s.lastLog)
+        {
+            if (s.repeats++ == 0)
+            {
+                s.firstRepeat = std::chrono::steady_clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(s.repeatTimer->mutex);
+                    s.repeatTimer->deadline = s.firstRepeat+s.repeatTimeout;
+                    s.repeatTimer->armed = true;
+                }
+                s.repeatTimer->wake.notify_one();
+            }
+            return;
+        }
+        dispatchRepeats(s);
+        // the copy keeps its capacity from one log to the next
+        s.lastLog.assign(log);
+        s.lastHash = hash;
+        s.lastLevel = level;
+        s.lastCode = code;
+    }
+    deliver(s,level,log,code,crashRecorded);
+}
+
+void NgoLoggerManager::deliver(State & s, TLogLevel level, std::string & log, int code, bool crashRecorded)
+{
+    if (!crashRecorded)
+        NgoCrashHandler::record(log.data(),log.size());
+    if (s.loggers.empty())
+    {
+        // no logger to allocate: while running, or for late logs, the log goes straight to stderr
+        if (phase_.load(std::memory_order_relaxed) != SHUT_DOWN || level <= logWARNING)
+            fputs(log.c_str(),stderr);
+        return;
+    }
+    // restored after, as a logger may log from its output
+    const int previous = currentCode;
+    currentCode = code;
+    for (size_t i=0;i<s.loggers.size();i++)
+    {
+        if (s.loggers[i]->worker_)
+            s.loggers[i]->worker_->push(level,log,code);
+        else
+            s.loggers[i]->output(level,log);
+    }
+    currentCode = previous;
 }
 
 void NgoLoggerManager::flush()
 {
-    for (int i=0;i<loggers_.size();i++)
-        loggers_[i]->flush();
+    State & s = state();
+    std::vector<std::pair<std::shared_ptr<NgoLoggerWorker>,unsigned long long> > tickets;
+    {
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        drainThreadBuffers();
+        dispatchRepeats(s);
+        for (size_t i=0;i<s.loggers.size();i++)
+        {
+            if (s.loggers[i]->worker_)
+                tickets.push_back(std::make_pair(s.loggers[i]->worker_,s.loggers[i]->worker_->requestFlush()));
+            else
+                s.loggers[i]->flush();
+        }
+    }
+    // all the workers flush at once, each after the logs dispatched before
+    for (size_t i=0;i<tickets.size();i++)
+        tickets[i].first->waitFlushed(tickets[i].second);
+}
+
+void NgoLoggerManager::waitForWorker(NgoLogger * logger)
+{
+    std::shared_ptr<NgoLoggerWorker> worker;
+    unsigned long long ticket = 0;
+    {
+        State & s = state();
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        worker = logger->worker_;
+        if (worker)
+            ticket = worker->requestFlush();
+    }
+    if (worker)
+        worker->waitFlushed(ticket);
+}
+
+void NgoLoggerManager::enableSinkWorkers()
+{
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    if (phase_.load(std::memory_order_relaxed) != RUNNING)
+        return;
+    s.sinkWorkers = true;
+    for (size_t i=0;i<s.loggers.size();i++)
+        if (!s.loggers[i]->worker_)
+            s.loggers[i]->worker_ = std::make_shared<NgoLoggerWorker>(s.loggers[i]);
+}
+
+void NgoLoggerManager::disableSinkWorkers()
+{
+    State & s = state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    drainThreadBuffers();
+    s.sinkWorkers = false;
+    // stopped under the lock: a log dispatched now must not reach a logger before its queue
+    for (size_t i=0;i<s.loggers.size();i++)
+    {
+        std::shared_ptr<NgoLoggerWorker> worker;
+        worker.swap(s.loggers[i]->worker_);
+        if (worker)
+            worker->stop();
+    }
+}
+
+void NgoLoggerManager::dispatchRepeats(State & s)
+{
+    if (!s.repeats)
+        return;
+    std::string log = levelNames[s.lastLevel];
+    log += "\t: last message repeated ";
+    log += std::to_string(s.repeats);
+    log += " times\n";
+    s.repeats = 0;
+    deliver(s,s.lastLevel,log,s.lastCode);
+}
+
+void NgoLoggerManager::enableRepeatCoalescing(double timeout)
+{
+    State & s = started();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    if (phase_.load(std::memory_order_relaxed) != RUNNING)
+        return;
+    s.repeatTimeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout));
+    if (s.coalescing)
+        return;
+    drainThreadBuffers();
+    s.coalescing = true;
+    s.lastHash = 0;
+    s.lastLog.clear();
+    s.repeats = 0;
+    std::shared_ptr<NgoLogRepeatTimer> timer = std::make_shared<NgoLogRepeatTimer>();
+    s.repeatTimer = timer;
+    timer->thread = std::thread([this,&s,timer]() {
+        std::unique_lock<std::mutex> lockTimer(timer->mutex);
+        for (;;)
+        {
+            timer->wake.wait(lockTimer,[&]{return timer->stop || timer->armed;});
+            if (timer->stop)
+                return;
+            if (timer->wake.wait_until(lockTimer,timer->deadline,[&]{return timer->stop;}))
+                return;
+            timer->armed = false;
+            // the manager lock is taken first
+            lockTimer.unlock();
+            {
+                std::lock_guard<std::recursive_mutex> lockManager(s.mutex);
+                if (s.repeats && s.repeatTimer == timer)
+                {
+                    const std::chrono::steady_clock::time_point due = s.firstRepeat+s.repeatTimeout;
+                    if (std::chrono::steady_clock::now() >= due)
+                    {
+                        try
+                        {
+                            dispatchRepeats(s);
+                        }
+                        catch (std::exception & e)
+                        {
+                            fprintf(stderr,"Log output failed: %s\n",e.what());
+                        }
+                        catch (...)
+                        {
+                            fprintf(stderr,"Log output failed: unknown exception\n");
+                        }
+                    }
+                    else
+                    {
+                        // the repeats were reported and counted again since the timer was armed
+                        std::lock_guard<std::mutex> lockRearm(timer->mutex);
+                        timer->deadline = due;
+                        timer->armed = true;
+                    }
+                }
+            }
+            lockTimer.lock();
+        }
+    });
+}
+
+void NgoLoggerManager::disableRepeatCoalescing()
+{
+    State & s = state();
+    std::shared_ptr<NgoLogRepeatTimer> timer;
+    {
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        drainThreadBuffers();
+        timer = stopRepeatCoalescing(s);
+    }
+    // joined without the lock, which the timer takes
+    if (timer)
+        timer->thread.join();
+}
+
+std::shared_ptr<NgoLogRepeatTimer> NgoLoggerManager::stopRepeatCoalescing(State & s)
+{
+    std::shared_ptr<NgoLogRepeatTimer> timer;
+    if (!s.coalescing)
+        return timer;
+    dispatchRepeats(s);
+    s.coalescing = false;
+    timer.swap(s.repeatTimer);
+    {
+        std::lock_guard<std::mutex> lock(timer->mutex);
+        timer->stop = true;
+    }
+    timer->wake.notify_one();
+    return timer;
+}
+
+void NgoLoggerManager::enableThreadBuffers(size_t capacity)
+{
+    bufferCapacity_.store(capacity ? capacity : 1,std::memory_order_relaxed);
+}
+
+void NgoLoggerManager::disableThreadBuffers()
+{
+    State & s = state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    bufferCapacity_.store(0,std::memory_order_relaxed);
+    drainThreadBuffers();
+}
+
+void NgoLoggerManager::appendToThreadBuffer(State & s, TLogLevel level, const std::string & log, int code)
+{
+    static thread_local NgoLogThreadBufferHandle handle;
+    if (!handle.buffer)
+    {
+        NgoLogThreadBuffer * buffer = new NgoLogThreadBuffer();
+        std::lock_guard<std::mutex> lock(s.buffersMutex);
+        s.buffers.push_back(buffer);
+        handle.buffer = buffer;
+        handle.buffersMutex = &s.buffersMutex;
+    }
+    // given to the crash handler now: a crash may happen before the buffer is merged
+    NgoCrashHandler::record(log.data(),log.size());
+    NgoLogThreadBuffer & buffer = *handle.buffer;
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        // stamped under the buffer lock: a merge reading the sequence then locking the buffer
+        // finds every log of this thread with a lower sequence
+        NgoLogBufferedRecord record;
+        record.sequence = s.sequence.fetch_add(1,std::memory_order_relaxed);
+        record.level = level;
+        record.code = code;
+        record.offset = buffer.text.size();
+        record.length = log.size();
+        buffer.text += log;
+        buffer.records.push_back(record);
+        full = buffer.text.size() >= bufferCapacity_.load(std::memory_order_relaxed);
+    }
+    if (full)
+        drainThreadBuffers();
+}
+
+void NgoLoggerManager::drainThreadBuffers()
+{
+    State & s = state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    // a logger logging from its output appends to its buffer, merged next time
+    if (s.draining)
+        return;
+    // reset even if a logger throws
+    struct DrainingGuard
+    {
+        DrainingGuard(bool & draining) : draining_(draining) {draining_ = true;};
+        ~DrainingGuard() {draining_ = false;};
+        bool & draining_;
+    } guard(s.draining);
+
+    // logs stamped from now on are kept for the next merge, so that no log is dispatched
+    // before a log of another thread with a lower sequence
+    const unsigned long long cutoff = s.sequence.load(std::memory_order_relaxed);
+    size_t nRuns = 0;
+    {
+        std::lock_guard<std::mutex> lockBuffers(s.buffersMutex);
+        for (size_t i=0;i<s.buffers.size();)
+        {
+            NgoLogThreadBuffer * buffer = s.buffers[i];
+            {
+                std::lock_guard<std::mutex> lockBuffer(buffer->mutex);
+                if (!buffer->records.empty())
+                {
+                    if (nRuns == s.runs.size())
+                        s.runs.push_back(NgoLogRun());
+                    NgoLogRun & run = s.runs[nRuns++];
+                    run.records.assign(buffer->records.begin(),buffer->records.end());
+                    run.text.assign(buffer->text);
+                    run.next = 0;
+                    // the thread keeps the capacity of its buffer
+                    buffer->records.clear();
+                    buffer->text.clear();
+                }
+            }
+            if (buffer->orphan)
+            {
+                delete buffer;
+                s.buffers[i] = s.buffers.back();
+                s.buffers.pop_back();
+            }
+            else
+                i++;
+        }
+    }
+    if (!s.carry.records.empty())
+    {
+        if (nRuns == s.runs.size())
+            s.runs.push_back(NgoLogRun());
+        NgoLogRun & run = s.runs[nRuns++];
+        run.records.swap(s.carry.records);
+        run.text.swap(s.carry.text);
+        run.next = 0;
+        s.carry.records.clear();
+        s.carry.text.clear();
+    }
+
+    // k-way merge of the runs on their next sequence
+    typedef std::pair<unsigned long long,size_t> Head;
+    s.heap.clear();
+    for (size_t r=0;r<nRuns;r++)
+        s.heap.push_back(Head(s.runs[r].records[0].sequence,r));
+    std::make_heap(s.heap.begin(),s.heap.end(),std::greater<Head>());
+    while (!s.heap.empty())
+    {
+        std::pop_heap(s.heap.begin(),s.heap.end(),std::greater<Head>());
+        const size_t r = s.heap.back().second;
+        NgoLogRun & run = s.runs[r];
+        s.heap.pop_back();
+        const NgoLogBufferedRecord & record = run.records[run.next++];
+        if (record.sequence < cutoff)
+        {
+            s.line.assign(run.text,record.offset,record.length);
+            dispatch(s,record.level,s.line,record.code,true);
+        }
+        else
+        {
+            NgoLogBufferedRecord kept = record;
+            kept.offset = s.carry.text.size();
+            s.carry.text.append(run.text,record.offset,record.length);
+            s.carry.records.push_back(kept);
+        }
+        if (run.next < run.records.size())
+        {
+            s.heap.push_back(Head(run.records[run.next].sequence,r));
+            std::push_heap(s.heap.begin(),s.heap.end(),std::greater<Head>());
+        }
+    }
 }
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+namespace
+{
+   /*! @brief true if a level given by a C or Fortran caller indexes the level names */
+   inline bool isLogLevel(TLogLevel level)
+   {
+      return (int)level >= (int)logERROR && (int)level <= (int)logDEBUG4;
+   }
+}
+
 int NgoLogf(TLogLevel level, const char * format, ... )
 {
-   char buffer[1024];
+   if (!isLogLevel(level))
+      return -1;
+   // the lock free check of NGOLOG: a disabled log neither formats nor locks
+   if (level > NGOLOG_MAX_LEVEL || !NgoLoggerManager::isEnabled(level))
+      return 1;
+   NgoLoggerManager * manager = NgoLoggerManager::get();
+
+   NgoLogRecordBuffer buffer;
+   std::string & record = buffer.start(level);
+   const size_t prefix = record.size();
+   // format in the spare capacity, the string is only grown for messages that do not fit
+   record.resize(record.capacity());
    va_list args;
    va_start (args, format);
-   vsprintf (buffer,format, args);
+   int n = vsnprintf(&record[prefix], record.size()-prefix+1, format, args);
    va_end (args);
-
-   //std::string str_msg = buffer;
-   NGOLOG(level) << buffer;
+   if (n < 0)
+      return -1;
+   if (prefix+n > record.size())
+   {
+      record.resize(prefix+n);
+      va_start (args, format);
+      vsnprintf(&record[prefix], n+1, format, args);
+      va_end (args);
+   }
+   record.resize(prefix+n);
+   record += '\n';
+   manager->addLog(level,record);
    return 1;
 }
 
-int NgoErrorSeverity_(NgoError & er)
+int NgoLogWriteBatch(const NgoLogEntry * entries, int count)
+{
+   if (!entries || count <= 0)
+      return 0;
+   // the entries are filtered as by NGOLOG before taking the lock, which is not taken if none is enabled
+   int enabled = 0;
+   for (int i=0;i<count;i++)
+   {
+      if (!isLogLevel(entries[i].level))
+         return -1;
+      if (entries[i].text && entries[i].level <= NGOLOG_MAX_LEVEL && NgoLoggerManager::isEnabled(entries[i].level))
+         enabled++;
+   }
+   if (!enabled)
+      return 0;
+   NgoLoggerManager * manager = NgoLoggerManager::get();
+   std::lock_guard<std::recursive_mutex> lock(manager->mutex());
+
+   NgoLogRecordBuffer buffer;
+   int written = 0;
+   for (int i=0;i<count;i++)
+   {
+      const NgoLogEntry & entry = entries[i];
+      if (!entry.text || entry.level > NGOLOG_MAX_LEVEL || !NgoLoggerManager::isEnabled(entry.level))
+         continue;
+      std::string & record = buffer.start(entry.level);
+      record.append(entry.text, entry.length < 0 ? strlen(entry.text) : entry.length);
+      record += '\n';
+      manager->addLog(entry.level,record);
+      written++;
+   }
+   return written;
+}
+
+int NgoErrorSeverity_(const NgoError & er)
 {
    switch( er.getCode() )
    {
@@ -343,7 +1500,7 @@ int NgoErrorSeverity_(NgoError & er)
    return 0;
 }
 
-std::string NgoErrorName_(NgoError & er)
+std::string NgoErrorName_(const NgoError & er)
 {
    std::string ret;
    switch( er.getCode() )
@@ -423,6 +1580,7 @@ void NgoLogError(NgoError & er)
        unique = true;
     
     NgoLog log(level,unique);
+    log.setCode(code);
     log.get() << NgoErrorName_(er) << std::endl;
     log.get() << er.getDescription() << std::endl;
     if ((NgoLoggerManager::get()->reportingLevel() >= logDEBUG)&&(!er.getScope().empty()))
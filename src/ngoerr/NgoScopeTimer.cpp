@@ -0,0 +1,392 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoScopeTimer.cpp
+@date October 2026
+@brief File containing the named timers and their latency histograms
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <utility>
+#ifdef _MSC_VER
+   #include <intrin.h>
+#endif
+
+#include "ngoerr/NgoScopeTimer.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+const size_t SUB_BUCKETS = size_t(1) << NGO_TIMER_SUB_BITS;
+
+inline int highestBit(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index,value);
+    return (int)index;
+#else
+    return 63-__builtin_clzll(value);
+#endif
+}
+
+/*! @brief bucket of a value: exact below 2*SUB_BUCKETS, then SUB_BUCKETS buckets per power of two */
+inline size_t bucketOf(uint64_t value)
+{
+    if (value < 2*SUB_BUCKETS)
+        return (size_t)value;
+    const int shift = highestBit(value)-NGO_TIMER_SUB_BITS;
+    return ((size_t)shift << NGO_TIMER_SUB_BITS) + (size_t)(value >> shift);
+}
+
+/*! @brief highest value of a bucket */
+inline uint64_t bucketUpperBound(size_t bucket)
+{
+    if (bucket < 2*SUB_BUCKETS)
+        return bucket;
+    const int shift = (int)(bucket >> NGO_TIMER_SUB_BITS)-1;
+    const uint64_t mantissa = (bucket & (SUB_BUCKETS-1)) + SUB_BUCKETS;
+    // wraps to the highest 64 bits value for the last bucket
+    return ((mantissa+1) << shift) - 1;
+}
+
+/*! @brief histogram of a timer for one thread */
+struct NgoTimerHistogram
+{
+    NgoTimerHistogram()
+    {
+        for (size_t i=0;i<NGO_TIMER_BUCKETS;i++)
+            counts[i].store(0,std::memory_order_relaxed);
+        sum.store(0,std::memory_order_relaxed);
+        max.store(0,std::memory_order_relaxed);
+    }
+    /*! @brief written by its thread only: loads and stores, no read-modify-write */
+    void record(uint64_t value)
+    {
+        std::atomic<uint64_t> & count = counts[bucketOf(value)];
+        count.store(count.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed)+value,std::memory_order_relaxed);
+        if (value > max.load(std::memory_order_relaxed))
+            max.store(value,std::memory_order_relaxed);
+    }
+    std::atomic<uint64_t> counts[NGO_TIMER_BUCKETS];
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+/*! @brief histograms of a timer. They are kept when the timer is destroyed, as threads may hold them */
+struct NgoTimerSlot
+{
+    NgoTimer * timer;
+    std::vector<NgoTimerHistogram *> histograms;
+    /*! @brief histograms given back by the threads which have exited */
+    std::vector<NgoTimerHistogram *> available;
+};
+
+struct NgoTimerState
+{
+    NgoTimerState() : stop(false) {};
+    /*! @brief lock of the slots, only taken the first time a thread records into a timer */
+    std::mutex mutex;
+    std::vector<NgoTimerSlot> slots;
+    /*! @brief lock of the lookup by name */
+    std::mutex namesMutex;
+
+    /*! @brief periodic reports */
+    std::mutex reportMutex;
+    std::condition_variable wake;
+    std::thread reporter;
+    bool stop;
+};
+
+/*! @brief never freed, as the threads give their histograms back at exit */
+NgoTimerState & timerState()
+{
+    static NgoTimerState * state = new NgoTimerState();
+    return *state;
+}
+
+/*! @brief histograms of a thread, indexed by timer, given back when the thread exits */
+struct NgoTimerThreadHandle
+{
+    ~NgoTimerThreadHandle()
+    {
+        NgoTimerState & t = timerState();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        for (size_t i=0;i<histograms.size();i++)
+            if (histograms[i])
+                t.slots[i].available.push_back(histograms[i]);
+    }
+    std::vector<NgoTimerHistogram *> histograms;
+};
+
+NgoTimerHistogram * acquireHistogram(NgoTimerThreadHandle & handle, size_t id)
+{
+    NgoTimerState & t = timerState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    NgoTimerSlot & slot = t.slots[id];
+    NgoTimerHistogram * histogram;
+    if (!slot.available.empty())
+    {
+        histogram = slot.available.back();
+        slot.available.pop_back();
+    }
+    else
+    {
+        histogram = new NgoTimerHistogram();
+        slot.histograms.push_back(histogram);
+    }
+    if (handle.histograms.size() <= id)
+        handle.histograms.resize(id+1,0L);
+    handle.histograms[id] = histogram;
+    return histogram;
+}
+
+NgoTimerSummary summarise(const std::vector<uint64_t> & counts, uint64_t sum, uint64_t max)
+{
+    NgoTimerSummary ret;
+    size_t highest = 0;
+    for (size_t i=0;i<counts.size();i++)
+    {
+        ret.count += counts[i];
+        if (counts[i])
+            highest = i;
+    }
+    if (!ret.count)
+        return ret;
+    // the maximum since the creation bounds the highest bucket, exact until a reset
+    ret.max = std::min(max,bucketUpperBound(highest));
+    ret.mean = (double)sum/(double)ret.count;
+    const double quantiles[] = {0.5, 0.99, 0.999};
+    uint64_t * values[] = {&ret.p50, &ret.p99, &ret.p999};
+    uint64_t cumulated = 0;
+    size_t q = 0;
+    for (size_t i=0;i<counts.size() && q<3;i++)
+    {
+        cumulated += counts[i];
+        while (q < 3 && (double)cumulated >= quantiles[q]*(double)ret.count)
+            *values[q++] = std::min(bucketUpperBound(i),ret.max);
+    }
+    return ret;
+}
+
+/*! @brief duration with 3 significant digits in the largest unit below 1000 */
+void appendDuration(std::string & out, uint64_t nanoseconds)
+{
+    static const char * const units[] = {"ns","us","ms","s"};
+    double value = (double)nanoseconds;
+    int unit = 0;
+    while (unit < 3 && value >= 999.5)
+    {
+        value /= 1000.;
+        unit++;
+    }
+    char buffer[32];
+    snprintf(buffer,sizeof(buffer),"%.3g%s",value,units[unit]);
+    out += buffer;
+}
+
+void reportLoop(double seconds, TLogLevel level)
+{
+    NgoTimerState & t = timerState();
+    const std::chrono::duration<double> period(seconds);
+    std::unique_lock<std::mutex> lock(t.reportMutex);
+    for (;;)
+    {
+        if (t.wake.wait_for(lock,period,[&t]() {return t.stop;}))
+            return;
+        lock.unlock();
+        NgoTimer::report(level,true);
+        lock.lock();
+    }
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoTimerSummary DEFINITION
+*******************************************************************************/
+NgoTimerSummary::NgoTimerSummary()
+:count(0),p50(0),p99(0),p999(0),max(0),mean(0.)
+{
+}
+
+std::string NgoTimerSummary::toString() const
+{
+    std::string ret = "n=" + std::to_string(count) + " p50=";
+    appendDuration(ret,p50);
+    ret += " p99=";
+    appendDuration(ret,p99);
+    ret += " p999=";
+    appendDuration(ret,p999);
+    ret += " max=";
+    appendDuration(ret,max);
+    return ret;
+}
+
+/*******************************************************************************
+   CLASS NgoTimer DEFINITION
+*******************************************************************************/
+NgoTimer::NgoTimer(const std::string & name)
+:name_(name),baselineSum_(0)
+{
+    NgoTimerState & t = timerState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    id_ = t.slots.size();
+    NgoTimerSlot slot;
+    slot.timer = this;
+    t.slots.push_back(slot);
+}
+
+NgoTimer::~NgoTimer()
+{
+    NgoTimerState & t = timerState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.slots[id_].timer = 0L;
+}
+
+void NgoTimer::record(uint64_t nanoseconds)
+{
+    static thread_local NgoTimerThreadHandle handle;
+    NgoTimerHistogram * histogram = id_ < handle.histograms.size() ? handle.histograms[id_] : 0L;
+    if (!histogram)
+        histogram = acquireHistogram(handle,id_);
+    histogram->record(nanoseconds);
+}
+
+void NgoTimer::merge(std::vector<uint64_t> & counts, uint64_t & sum, uint64_t & max) const
+{
+    const NgoTimerSlot & slot = timerState().slots[id_];
+    counts.assign(NGO_TIMER_BUCKETS,0);
+    sum = max = 0;
+    for (size_t h=0;h<slot.histograms.size();h++)
+    {
+        const NgoTimerHistogram & histogram = *slot.histograms[h];
+        for (size_t i=0;i<NGO_TIMER_BUCKETS;i++)
+            counts[i] += histogram.counts[i].load(std::memory_order_relaxed);
+        sum += histogram.sum.load(std::memory_order_relaxed);
+        max = std::max(max,histogram.max.load(std::memory_order_relaxed));
+    }
+    if (baseline_.empty())
+        return;
+    for (size_t i=0;i<NGO_TIMER_BUCKETS;i++)
+        counts[i] -= baseline_[i];
+    sum -= baselineSum_;
+}
+
+NgoTimerSummary NgoTimer::summary() const
+{
+    std::vector<uint64_t> counts;
+    uint64_t sum, max;
+    {
+        std::lock_guard<std::mutex> lock(timerState().mutex);
+        merge(counts,sum,max);
+    }
+    return summarise(counts,sum,max);
+}
+
+void NgoTimer::reset()
+{
+    std::lock_guard<std::mutex> lock(timerState().mutex);
+    std::vector<uint64_t> counts;
+    uint64_t sum, max;
+    merge(counts,sum,max);
+    if (baseline_.empty())
+        baseline_.assign(NGO_TIMER_BUCKETS,0);
+    for (size_t i=0;i<NGO_TIMER_BUCKETS;i++)
+        baseline_[i] += counts[i];
+    baselineSum_ += sum;
+}
+
+NgoTimer & NgoTimer::get(const std::string & name)
+{
+    NgoTimerState & t = timerState();
+    std::lock_guard<std::mutex> lockNames(t.namesMutex);
+    {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        for (size_t i=0;i<t.slots.size();i++)
+            if (t.slots[i].timer && t.slots[i].timer->name_ == name)
+                return *t.slots[i].timer;
+    }
+    return *new NgoTimer(name);
+}
+
+void NgoTimer::report(TLogLevel level, bool reset)
+{
+    if (!NgoLoggerManager::isEnabled(level))
+        return;
+    std::vector<std::pair<std::string,NgoTimerSummary> > summaries;
+    {
+        NgoTimerState & t = timerState();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        std::vector<uint64_t> counts;
+        uint64_t sum, max;
+        for (size_t i=0;i<t.slots.size();i++)
+        {
+            NgoTimer * timer = t.slots[i].timer;
+            if (!timer)
+                continue;
+            timer->merge(counts,sum,max);
+            NgoTimerSummary summary = summarise(counts,sum,max);
+            if (!summary.count)
+                continue;
+            summaries.push_back(std::make_pair(timer->name_,summary));
+            if (!reset)
+                continue;
+            if (timer->baseline_.empty())
+                timer->baseline_.assign(NGO_TIMER_BUCKETS,0);
+            for (size_t b=0;b<NGO_TIMER_BUCKETS;b++)
+                timer->baseline_[b] += counts[b];
+            timer->baselineSum_ += sum;
+        }
+    }
+    // logged without the lock, a logger may time its output
+    for (size_t i=0;i<summaries.size();i++)
+        NGOLOG(level) << "timer " << summaries[i].first << " : " << summaries[i].second.toString();
+}
+
+void NgoTimer::reportEvery(double seconds, TLogLevel level)
+{
+    stopReporting();
+    NgoTimerState & t = timerState();
+    std::lock_guard<std::mutex> lock(t.reportMutex);
+    t.stop = false;
+    t.reporter = std::thread(reportLoop,seconds,level);
+}
+
+void NgoTimer::stopReporting()
+{
+    NgoTimerState & t = timerState();
+    std::thread reporter;
+    {
+        std::lock_guard<std::mutex> lock(t.reportMutex);
+        if (!t.reporter.joinable())
+            return;
+        t.stop = true;
+        reporter.swap(t.reporter);
+    }
+    t.wake.notify_all();
+    reporter.join();
+}
@@ -0,0 +1,303 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file NgoTrace.cpp
+@date October 2026
+@brief File containing the tracing spans and their export in the Chrome trace event format
+ */
+/*******************************************************************************
+   LICENSE
+*******************************************************************************
+ Copyright (C) 2012 Numengo (admin@numengo.com)
+
+ This document is released under the terms of the numenGo EULA.  You should have received a
+ copy of the numenGo EULA along with this file; see  the file LICENSE.TXT. If not, write at
+ admin@numengo.com or at NUMENGO, 15 boulevard Vivier Merle, 69003 LYON - FRANCE
+ You are not allowed to use, copy, modify or distribute this file unless you  conform to numenGo
+ EULA license.
+*/
+
+
+
+/*******************************************************************************
+   INCLUDES
+*******************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#ifdef _MSC_VER
+   #include <process.h>
+#else
+   #include <unistd.h>
+#endif
+
+#include "ngoerr/NgoTrace.h"
+/*******************************************************************************
+   DEFINES / TYPDEFS / ENUMS
+*******************************************************************************/
+namespace
+{
+/*! @brief span stack of a thread, constant initialised */
+struct NgoTraceStack
+{
+    const char * names[NGO_TRACE_MAX_DEPTH];
+    unsigned depth;
+};
+
+thread_local NgoTraceStack stack;
+
+struct NgoTraceEvent
+{
+    const char * name;
+    int64_t nanoseconds;
+    char phase;
+};
+
+/*! @brief events of a thread */
+struct NgoTraceBuffer
+{
+    NgoTraceBuffer(unsigned id) : tid(id),session(0),dropped(0),exited(false) {};
+    /*! @brief only shared with the export, so recording is not contended */
+    std::mutex mutex;
+    std::vector<NgoTraceEvent> events;
+    unsigned tid;
+    /*! @brief session of the events, which are cleared by the thread when it records in a newer one */
+    unsigned session;
+    size_t dropped;
+    /*! @brief set under the state lock when the thread exits, the buffer is freed by the next start */
+    bool exited;
+};
+
+struct NgoTraceState
+{
+    NgoTraceState() : current(0),capacity(0),last(0),nextTid(0) {};
+    /*! @brief session recorded, 0 when stopped */
+    std::atomic<unsigned> current;
+    std::atomic<size_t> capacity;
+    /*! @brief lock of the buffers list and of the fields below */
+    std::mutex mutex;
+    std::vector<NgoTraceBuffer *> buffers;
+    /*! @brief last session started, the one exported */
+    unsigned last;
+    unsigned nextTid;
+    std::chrono::steady_clock::time_point origin;
+};
+
+/*! @brief never freed, as threads may record after the static destructors */
+NgoTraceState & traceState()
+{
+    static NgoTraceState * state = new NgoTraceState();
+    return *state;
+}
+
+int64_t now()
+{
+    return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*! @brief buffer of a thread, registered when it first records */
+struct NgoTraceThreadHandle
+{
+    NgoTraceThreadHandle() : buffer(0L) {};
+    ~NgoTraceThreadHandle()
+    {
+        if (!buffer)
+            return;
+        NgoTraceState & t = traceState();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        buffer->exited = true;
+    }
+    NgoTraceBuffer * buffer;
+};
+
+NgoTraceBuffer & threadBuffer()
+{
+    static thread_local NgoTraceThreadHandle handle;
+    if (!handle.buffer)
+    {
+        NgoTraceState & t = traceState();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        handle.buffer = new NgoTraceBuffer(++t.nextTid);
+        t.buffers.push_back(handle.buffer);
+    }
+    return *handle.buffer;
+}
+
+/*! @brief records an event of a session, false if it is dropped */
+bool record(unsigned session, const char * name, char phase)
+{
+    const int64_t nanoseconds = now();
+    NgoTraceBuffer & buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.session != session)
+    {
+        // the end of a span begun in a previous session
+        if (phase == 'E')
+            return false;
+        buffer.events.clear();
+        buffer.session = session;
+        buffer.dropped = 0;
+    }
+    // the ends are kept beyond the capacity, so that every beginning recorded is closed
+    if (phase == 'B' && buffer.events.size() >= traceState().capacity.load(std::memory_order_relaxed))
+    {
+        buffer.dropped++;
+        return false;
+    }
+    NgoTraceEvent event = {name,nanoseconds,phase};
+    buffer.events.push_back(event);
+    return true;
+}
+
+void appendEscaped(std::string & out, const char * s)
+{
+    for (;*s;s++)
+    {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += (char)c;
+        }
+        else if (c < 0x20)
+        {
+            char buffer[8];
+            snprintf(buffer,sizeof(buffer),"\\u%04x",c);
+            out += buffer;
+        }
+        else
+            out += (char)c;
+    }
+}
+} // end of anonymous namespace
+
+/*******************************************************************************
+   CLASS NgoTrace DEFINITION
+*******************************************************************************/
+void NgoTrace::start(size_t capacity)
+{
+    NgoTraceState & t = traceState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    std::vector<NgoTraceBuffer *> kept;
+    for (size_t i=0;i<t.buffers.size();i++)
+    {
+        if (t.buffers[i]->exited)
+            delete t.buffers[i];
+        else
+            kept.push_back(t.buffers[i]);
+    }
+    t.buffers.swap(kept);
+    if (++t.last == 0)
+        ++t.last;
+    t.origin = std::chrono::steady_clock::now();
+    t.capacity.store(capacity,std::memory_order_relaxed);
+    t.current.store(t.last,std::memory_order_release);
+}
+
+void NgoTrace::stop()
+{
+    traceState().current.store(0,std::memory_order_release);
+}
+
+bool NgoTrace::recording()
+{
+    return traceState().current.load(std::memory_order_acquire) != 0;
+}
+
+size_t NgoTrace::dropped()
+{
+    NgoTraceState & t = traceState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    size_t dropped = 0;
+    for (size_t i=0;i<t.buffers.size();i++)
+    {
+        std::lock_guard<std::mutex> lockBuffer(t.buffers[i]->mutex);
+        if (t.buffers[i]->session == t.last)
+            dropped += t.buffers[i]->dropped;
+    }
+    return dropped;
+}
+
+std::string NgoTrace::chromeJson()
+{
+#ifdef _MSC_VER
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    NgoTraceState & t = traceState();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    const int64_t origin = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t.origin.time_since_epoch()).count();
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    char buffer[96];
+    for (size_t i=0;i<t.buffers.size();i++)
+    {
+        NgoTraceBuffer & b = *t.buffers[i];
+        std::lock_guard<std::mutex> lockBuffer(b.mutex);
+        if (b.session != t.last || b.events.empty())
+            continue;
+        snprintf(buffer,sizeof(buffer),"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,",
+                 first ? "" : ",",pid,b.tid);
+        out += buffer;
+        snprintf(buffer,sizeof(buffer),"\"args\":{\"name\":\"thread %u\"}}",b.tid);
+        out += buffer;
+        first = false;
+        for (size_t j=0;j<b.events.size();j++)
+        {
+            const NgoTraceEvent & e = b.events[j];
+            out += ",\n{\"name\":\"";
+            appendEscaped(out,e.name);
+            // timestamps in microseconds since the start of the session
+            snprintf(buffer,sizeof(buffer),"\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                     e.phase,(double)(e.nanoseconds-origin)/1000.,pid,b.tid);
+            out += buffer;
+        }
+    }
+    out += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return out;
+}
+
+void NgoTrace::write(const std::string & filename)
+{
+    const std::string json = chromeJson();
+    FILE * file = fopen(filename.c_str(),"wb");
+    if (!file)
+        throw NgoError("Impossible to write the trace " + filename,"NgoTrace::write");
+    const bool written = fwrite(json.data(),1,json.size(),file) == json.size();
+    if (fclose(file) != 0 || !written)
+        throw NgoError("Impossible to write the trace " + filename,"NgoTrace::write");
+}
+
+unsigned NgoTrace::begin(const char * name)
+{
+    NgoTraceStack & s = stack;
+    if (s.depth < NGO_TRACE_MAX_DEPTH)
+        s.names[s.depth] = name;
+    s.depth++;
+    const unsigned session = traceState().current.load(std::memory_order_acquire);
+    if (!session || !record(session,name,'B'))
+        return 0;
+    return session;
+}
+
+void NgoTrace::end(const char * name, unsigned session)
+{
+    stack.depth--;
+    if (session)
+        record(session,name,'E');
+}
+
+unsigned NgoTrace::spans(const char ** names, unsigned max)
+{
+    const NgoTraceStack & s = stack;
+    const unsigned stored = s.depth < NGO_TRACE_MAX_DEPTH ? s.depth : NGO_TRACE_MAX_DEPTH;
+    const unsigned n = stored < max ? stored : max;
+    for (unsigned i=0;i<n;i++)
+        names[i] = s.names[stored-n+i];
+    return s.depth;
+}
@@ -0,0 +1,164 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file stress.cpp
+@date October 2026
+@brief Multithreaded stress test of the logging system.
+
+Every thread hammers at the same time NGOLOG, unique logs, NgoLogError, the registration
+and unregistration of loggers and NgoLoggerBufferedString::getBufferedMessage.
+The test is run with 1, 2, 4, ... up to N threads and reports for each run the throughput
+as one JSON object per line, along with the scaling relative to the single thread run.
+The number of records received by a counting logger is checked after each run, and the
+program returns a non zero code if a record has been lost or duplicated.
+
+The target is meant to be run under ThreadSanitizer too (premake option --tsan).
+With --thread-buffers, the logs go through the per thread buffers of the manager.
+With --sink-workers, each logger outputs its logs from its own worker thread.
+
+Usage : stress_NgoErr [--threads=N] [--ops=operations per thread] [--thread-buffers] [--sink-workers]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ngoerr/NgoError.h"
+#include "ngoerr/NgoLogging.h"
+
+namespace
+{
+/*! @brief number of distinct unique logs emitted by all threads */
+const unsigned UNIQUE_LOGS = 8;
+
+/*! @brief logger counting the records it receives. output is called under the manager lock */
+class NgoLoggerCounter : public NgoLogger
+{
+public:
+    NgoLoggerCounter(TLogLevel reportingLevel=logDEBUG4) : NgoLogger(reportingLevel), count_(0) {}
+    virtual void output(const TLogLevel level, std::string &)
+    {
+        if (level <= reportingLevel_)
+            count_++;
+    }
+    virtual void flush() {}
+    unsigned long long count() const { return count_; }
+private:
+    unsigned long long count_;
+};
+
+/*! @brief operations done by a thread. Returns the number of records which reach the counter */
+unsigned long long worker(unsigned id, unsigned long long ops, NgoLoggerBufferedString * shared)
+{
+    unsigned long long records = 0;
+    for (unsigned long long i=0;i<ops;i++)
+    {
+        NGOLOG(logDEBUG) << "thread " << id << " iteration " << i;
+        records++;
+        if ((i & 15) == 0)
+            NgoLog(logINFO,true).get() << "unique log " << (i/16)%UNIQUE_LOGS;
+        if ((i & 31) == 0)
+            shared->getBufferedMessage();
+        if ((i & 63) == 0)
+        {
+            try
+            {
+                throw NgoErrorSolving("no convergence","stress");
+            }
+            catch (NgoError & er)
+            {
+                NgoLogError(er);
+                records++;
+            }
+        }
+        if ((i & 127) == 0)
+        {
+            NgoLoggerBufferedString * temporary = new NgoLoggerBufferedString(logINFO);
+            NGOLOG(logINFO) << "temporary logger of thread " << id;
+            records++;
+            delete temporary;
+        }
+    }
+    return records;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char ** argv)
+{
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    unsigned long long ops = 20000;
+    bool threadBuffers = false;
+    bool sinkWorkers = false;
+    for (int i=1;i<argc;i++)
+    {
+        if (strcmp(argv[i],"--thread-buffers") == 0)
+            threadBuffers = true;
+        else if (strcmp(argv[i],"--sink-workers") == 0)
+            sinkWorkers = true;
+        else if (strncmp(argv[i],"--threads=",10) == 0)
+            maxThreads = atoi(argv[i]+10);
+        else if (strncmp(argv[i],"--ops=",6) == 0)
+            ops = strtoull(argv[i]+6,0L,10);
+    }
+    if (maxThreads < 1)
+        maxThreads = 1;
+    std::string name = "mixed";
+    if (threadBuffers)
+        name += "_thread_buffers";
+    if (sinkWorkers)
+        name += "_sink_workers";
+
+    int ret = 0;
+    double reference = 0.;
+    for (unsigned threads=1;;threads*=2)
+    {
+        if (threads > maxThreads)
+            threads = maxThreads;
+
+        NgoLoggerCounter * counter = new NgoLoggerCounter(logDEBUG);
+        NgoLoggerBufferedString * shared = new NgoLoggerBufferedString(logDEBUG);
+        if (threadBuffers)
+            NgoLoggerManager::get()->enableThreadBuffers();
+        if (sinkWorkers)
+            NgoLoggerManager::get()->enableSinkWorkers();
+        std::vector<unsigned long long> records(threads,0);
+        std::vector<std::thread> pool;
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (unsigned t=0;t<threads;t++)
+            pool.push_back(std::thread([t,ops,shared,&records]() { records[t] = worker(t,ops,shared); }));
+        for (unsigned t=0;t<threads;t++)
+            pool[t].join();
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+        unsigned long long expected = UNIQUE_LOGS;
+        for (unsigned t=0;t<threads;t++)
+            expected += records[t];
+        NgoLoggerManager::get()->flush();
+        unsigned long long received = counter->count();
+        NgoLoggerManager::kill();
+
+        double seconds = std::chrono::duration<double>(t1-t0).count();
+        double throughput = threads*ops/seconds;
+        if (threads == 1)
+            reference = throughput;
+        printf("{\"stress\":\"%s\",\"threads\":%u,\"ops\":%llu,\"seconds\":%.4f,\"ops_per_sec\":%.0f,\"scaling\":%.2f,\"records\":%llu,\"expected\":%llu}\n",
+               name.c_str(), threads, threads*ops, seconds, throughput, throughput/reference, received, expected);
+        fflush(stdout);
+        if (received != expected)
+        {
+            fprintf(stderr,"stress_NgoErr: %llu records received instead of %llu with %u threads\n",received,expected,threads);
+            ret = 1;
+        }
+        if (threads == maxThreads)
+            break;
+    }
+    return ret;
+}
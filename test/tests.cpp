@@ -3,8 +3,31 @@
 
 #include "ngoerr/NgoError.h"
 #include "ngoerr/NgoLogging.h"
+#include "ngoerr/NgoCrashHandler.h"
+#include "ngoerr/NgoLoggerSharedMemory.h"
+#include "ngoerr/NgoLoggerCompressed.h"
+#include "ngoerr/NgoLogIndex.h"
+#include "ngoerr/NgoLogConfig.h"
+#include "ngoerr/NgoScopeTimer.h"
+#include "ngoerr/NgoTrace.h"
+#include "ngoerr/NgoErrorCollector.h"
+#include "ngoerr/NgoErrorChecks.h"
+#include "ngoerr/NgoFpeGuard.h"
+#include "ngoerr/NgoLastError.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <signal.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 void logSomeStuff()
 {
@@ -23,6 +46,19 @@ void logSomeStuff()
     }
 }
 
+NGOLOG_DEFINE_CATEGORY(NgoLogTestKernel, logWARNING);
+
+static_assert(NgoLogCategoryEnabled<NgoLogTestKernel>(logERROR, NGOLOG_MAX_LEVEL), "ERROR must be compiled in");
+static_assert(NgoLogCategoryEnabled<NgoLogTestKernel>(logWARNING, NGOLOG_MAX_LEVEL), "WARNING must be compiled in");
+static_assert(!NgoLogCategoryEnabled<NgoLogTestKernel>(logINFO, NGOLOG_MAX_LEVEL), "INFO must be compiled out");
+static_assert(NgoLogCategoryEnabled<NgoLogDefaultCategory>(logDEBUG4, NGOLOG_MAX_LEVEL), "default category has no ceiling");
+
+static int evaluations = 0;
+int countEvaluation()
+{
+    return ++evaluations;
+}
+
 namespace
 {
 TEST(LogDefault)
@@ -104,6 +140,355 @@ TEST(LogFromCFormattedFunction)
     NgoLoggerManager::kill();
 }
 
+TEST(LogEnabledLevelFollowsLoggers)
+{
+    NgoLoggerManager::kill();
+    CHECK(NgoLoggerManager::isEnabled(logDEBUG4));
+    NgoLoggerManager::get()->getBufferedLogger()->setReportingLevel(logWARNING);
+    CHECK(NgoLoggerManager::isEnabled(logWARNING));
+    CHECK(!NgoLoggerManager::isEnabled(logINFO));
+
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logINFO);
+    CHECK(NgoLoggerManager::isEnabled(logINFO));
+    logger->setReportingLevel(logDEBUG2);
+    CHECK(NgoLoggerManager::isEnabled(logDEBUG2));
+    CHECK(!NgoLoggerManager::isEnabled(logDEBUG3));
+    NGOLOG(logDEBUG3) << "filtered";
+    NGOLOG(true ? logDEBUG2 : logERROR) << "level expression";
+    CHECK_EQUAL(std::string("DEBUG2\t: level expression\n"), std::string(logger->getBufferedMessage()));
+
+    delete logger;
+    CHECK(!NgoLoggerManager::isEnabled(logINFO));
+    NgoLoggerManager::kill();
+    CHECK(NgoLoggerManager::isEnabled(logDEBUG4));
+}
+
+TEST(LogThreadBuffersMergeInSequence)
+{
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    NgoLoggerManager::get()->enableThreadBuffers();
+    NGOLOG(logINFO) << "A";
+    std::thread([]() { NGOLOG(logINFO) << "B"; }).join();
+    NGOLOG(logINFO) << "C";
+    CHECK(logger->isBufferEmpty());
+    CHECK_EQUAL(std::string("INFO\t: A\nINFO\t: B\nINFO\t: C\n"), std::string(logger->getBufferedMessage()));
+
+    // concurrent threads: every log arrives once, each thread in its own order
+    const int threads = 4, logs = 500;
+    std::vector<std::thread> pool;
+    for (int t=0;t<threads;t++)
+        pool.push_back(std::thread([t]() {
+            for (int i=0;i<logs;i++)
+                NGOLOG(logINFO) << t << " " << i;
+        }));
+    for (int t=0;t<threads;t++)
+        pool[t].join();
+    NgoLoggerManager::get()->flush();
+    std::istringstream lines(logger->getBufferedMessage());
+    std::string level, colon;
+    int t, i, count = 0;
+    std::vector<int> next(threads,0);
+    bool ordered = true;
+    while (lines >> level >> colon >> t >> i)
+    {
+        ordered = ordered && (i == next[t]);
+        next[t] = i+1;
+        count++;
+    }
+    CHECK_EQUAL(threads*logs, count);
+    CHECK(ordered);
+
+    // a small capacity merges as the buffers fill
+    NgoLoggerManager::get()->enableThreadBuffers(64);
+    for (int i=0;i<10;i++)
+        NGOLOG(logINFO) << "filling the buffer " << i;
+    NgoLoggerManager::get()->disableThreadBuffers();
+    CHECK_EQUAL(10*(int)std::string("INFO\t: filling the buffer 0\n").size(), (int)std::string(logger->getBufferedMessage()).size());
+    NgoLoggerManager::kill();
+}
+
+/*! @brief logger whose output waits until it is opened, standing for a slow file system */
+class NgoLoggerGated : public NgoLogger
+{
+public:
+    NgoLoggerGated() : NgoLogger(logDEBUG4,false), open_(false) {registerLogger();}
+    ~NgoLoggerGated() {unregisterLogger();}
+    virtual void output(const TLogLevel, std::string & log)
+    {
+        entered_++;
+        std::unique_lock<std::mutex> lock(mutex_);
+        gate_.wait(lock,[this]() {return open_;});
+        text_ += log;
+        codes_.push_back(NgoLoggerManager::recordCode());
+    }
+    virtual void flush() {flushed_++;}
+    void open()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+        }
+        gate_.notify_all();
+    }
+    std::string text_;
+    std::vector<int> codes_;
+    int flushed_ = 0;
+    std::atomic<int> entered_{0};
+private:
+    std::mutex mutex_;
+    std::condition_variable gate_;
+    bool open_;
+};
+
+TEST(LogSinkWorkers)
+{
+    NgoLoggerBufferedString * fast = new NgoLoggerBufferedString(logDEBUG4);
+    NgoLoggerGated * slow = new NgoLoggerGated();
+    NgoLoggerManager::get()->enableSinkWorkers();
+    // the slow logger holds its worker, not the logging thread nor the other logger
+    NGOLOG(logINFO) << "A";
+    {
+        NgoLog log(logINFO);
+        log.setCode(E_INVALIDARGUMENT);
+        log.get() << "B";
+    }
+    std::thread([]() { NGOLOG(logINFO) << "C"; }).join();
+    CHECK_EQUAL(std::string("INFO\t: A\nINFO\t: B\nINFO\t: C\n"), std::string(fast->getBufferedMessage()));
+    CHECK(slow->text_.empty());
+
+    // flush waits for every worker, which flushes its logger after the logs dispatched before
+    slow->open();
+    NgoLoggerManager::get()->flush();
+    CHECK_EQUAL(std::string("INFO\t: A\nINFO\t: B\nINFO\t: C\n"), slow->text_);
+    CHECK_EQUAL(3, (int)slow->codes_.size());
+    CHECK_EQUAL((int)E_OK, slow->codes_[0]);
+    CHECK_EQUAL((int)E_INVALIDARGUMENT, slow->codes_[1]);
+    CHECK_EQUAL(1, slow->flushed_);
+
+    // a logger registered later gets its worker, in order. A logger deleted outputs its queue first
+    NgoLoggerBufferedString * late = new NgoLoggerBufferedString(logDEBUG4);
+    for (int i=0;i<100;i++)
+        NGOLOG(logINFO) << i;
+    delete slow;
+    std::istringstream lines(late->getBufferedMessage());
+    std::string level, colon;
+    int i, count = 0;
+    bool ordered = true;
+    while (lines >> level >> colon >> i)
+        ordered = ordered && (i == count++);
+    CHECK_EQUAL(100, count);
+    CHECK(ordered);
+
+    NgoLoggerManager::get()->disableSinkWorkers();
+    NGOLOG(logINFO) << "D";
+    CHECK_EQUAL(std::string("INFO\t: D\n"), std::string(late->getBufferedMessage()));
+    NgoLoggerManager::kill();
+}
+
+TEST(LogBackpressure)
+{
+    // a buffered string drops while nobody retrieves it, and tells how many once retrieved
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    logger->setBackpressure(logDROP_NEWEST,3);
+    for (int i=0;i<5;i++)
+        NGOLOG(logINFO) << i;
+    CHECK_EQUAL(std::string("INFO\t: 0\nINFO\t: 1\nINFO\t: 2\nWARNING\t: 2 records dropped\n"), std::string(logger->getBufferedMessage()));
+    logger->setBackpressure(logDROP_OLDEST,3);
+    for (int i=0;i<8;i++)
+        NGOLOG(logINFO) << i;
+    CHECK_EQUAL(std::string("INFO\t: 5\nINFO\t: 6\nINFO\t: 7\nWARNING\t: 5 records dropped\n"), std::string(logger->getBufferedMessage()));
+    logger->setBackpressure(logDROP_BELOW_LEVEL,2);
+    NGOLOG(logINFO) << "a";
+    NGOLOG(logDEBUG) << "b";
+    NGOLOG(logINFO) << "c";
+    NGOLOG(logWARNING) << "d";
+    NGOLOG(logERROR) << "e";
+    CHECK_EQUAL(std::string("INFO\t: a\nDEBUG\t: b\nWARNING\t: d\nERROR\t: e\nWARNING\t: 1 records dropped\n"), std::string(logger->getBufferedMessage()));
+    CHECK_EQUAL(8ULL, logger->dropped());
+    NgoLoggerManager::kill();
+
+    // the queue of a worker: the first log holds the worker, the queue fills behind it
+    NgoLoggerGated * slow = new NgoLoggerGated();
+    slow->setBackpressure(logDROP_NEWEST,2);
+    NgoLoggerManager::get()->enableSinkWorkers();
+    NGOLOG(logINFO) << "A";
+    while (!slow->entered_)
+        std::this_thread::yield();
+    for (int i=0;i<5;i++)
+        NGOLOG(logINFO) << i;
+    CHECK_EQUAL(3ULL, slow->dropped());
+    slow->open();
+    NgoLoggerManager::get()->flush();
+    CHECK_EQUAL(std::string("INFO\t: A\nINFO\t: 0\nINFO\t: 1\nWARNING\t: 3 records dropped\n"), slow->text_);
+    NgoLoggerManager::kill();
+
+    // blocking: the dispatch waits for the worker, nothing is dropped
+    slow = new NgoLoggerGated();
+    slow->setBackpressure(logBLOCK,1);
+    NgoLoggerManager::get()->enableSinkWorkers();
+    NGOLOG(logINFO) << "A";
+    while (!slow->entered_)
+        std::this_thread::yield();
+    NGOLOG(logINFO) << "B";
+    std::atomic<bool> logged(false);
+    std::thread blocked([&logged]() { NGOLOG(logINFO) << "C"; logged = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!logged);
+    slow->open();
+    blocked.join();
+    NgoLoggerManager::get()->flush();
+    CHECK_EQUAL(std::string("INFO\t: A\nINFO\t: B\nINFO\t: C\n"), slow->text_);
+    CHECK_EQUAL(0ULL, slow->dropped());
+    NgoLoggerManager::kill();
+}
+
+TEST(LogRepeatCoalescing)
+{
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    NgoLoggerManager::get()->enableRepeatCoalescing(60.);
+    for (int i=0;i<1000;i++)
+        NGOLOG(logWARNING) << "pressure clipped";
+    NGOLOG(logINFO) << "pressure clipped";
+    NGOLOG(logINFO) << "converged";
+    NGOLOG(logINFO) << "converged";
+    CHECK_EQUAL(std::string("WARNING\t: pressure clipped\nWARNING\t: last message repeated 999 times\n"
+                            "INFO\t: pressure clipped\nINFO\t: converged\n"), std::string(logger->getBufferedMessage()));
+    // reported on flush
+    NgoLoggerManager::get()->flush();
+    CHECK_EQUAL(std::string("INFO\t: last message repeated 1 times\n"), std::string(logger->getBufferedMessage()));
+
+    // reported once the timeout has passed, without another log
+    NgoLoggerManager::get()->enableRepeatCoalescing(0.02);
+    NGOLOG(logINFO) << "converged";
+    NGOLOG(logINFO) << "converged";
+    for (int i=0;i<400 && logger->isBufferEmpty();i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK_EQUAL(std::string("INFO\t: last message repeated 2 times\n"), std::string(logger->getBufferedMessage()));
+
+    // from the thread buffers, and reported when disabled
+    NgoLoggerManager::get()->enableThreadBuffers();
+    std::thread worker([]() {
+        for (int i=0;i<10;i++)
+            NGOLOG(logDEBUG) << "iteration";
+    });
+    worker.join();
+    NgoLoggerManager::get()->disableRepeatCoalescing();
+    CHECK_EQUAL(std::string("DEBUG\t: iteration\nDEBUG\t: last message repeated 9 times\n"), std::string(logger->getBufferedMessage()));
+    NGOLOG(logDEBUG) << "iteration";
+    NGOLOG(logDEBUG) << "iteration";
+    NgoLoggerManager::get()->disableThreadBuffers();
+    CHECK_EQUAL(std::string("DEBUG\t: iteration\nDEBUG\t: iteration\n"), std::string(logger->getBufferedMessage()));
+
+    NgoLoggerManager::kill();
+
+    // reported when the manager stops
+    FILE * file = tmpfile();
+    CHECK(file != 0L);
+    new NgoLoggerFile(file,logDEBUG4);
+    NgoLoggerManager::get()->enableRepeatCoalescing();
+    NGOLOG(logINFO) << "done";
+    NGOLOG(logINFO) << "done";
+    NgoLoggerManager::kill();
+    rewind(file);
+    char text[256] = {0};
+    CHECK(fread(text,1,sizeof(text)-1,file) > 0);
+    fclose(file);
+    CHECK_EQUAL(std::string("INFO\t: done\nINFO\t: last message repeated 1 times\n"), std::string(text));
+}
+
+TEST(LogDoublesFormat)
+{
+    const double values[] = {0., -0., 1., -1.5, 1.23456789, 9.999995, 9.999994999, 1e-300, 4.9e-324,
+                             1.7976931348623157e308, 123456.789e10, -2.5e-5, 0.1, 1./3.,
+                             std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                             std::numeric_limits<double>::quiet_NaN()};
+    const size_t n = sizeof(values)/sizeof(values[0]);
+    // the text of the stream formatting of NgoLog before the facet
+    std::ostringstream reference;
+    reference.imbue(std::locale::classic());
+    reference.setf(std::ios::scientific,std::ios::floatfield);
+    reference.precision(5);
+    reference << "INFO\t: ";
+    for (size_t i=0;i<n;i++)
+        reference << values[i] << ";";
+    reference << std::setprecision(12) << values[4] << ";" << std::setw(14) << values[3] << ";"
+              << std::fixed << values[4] << ";" << std::defaultfloat << values[4] << ";" << 2.5f << "\n";
+    reference << "DEBUG\t: " << std::scientific << std::setprecision(5);
+    for (size_t i=0;i<n;i++)
+        reference << (i ? ", " : "") << values[i];
+    reference << "\n";
+
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    {
+        NgoLog log(logINFO);
+        for (size_t i=0;i<n;i++)
+            log.get() << values[i] << ";";
+        log.get() << std::setprecision(12) << values[4] << ";" << std::setw(14) << values[3] << ";"
+                  << std::fixed << values[4] << ";" << std::defaultfloat << values[4] << ";" << 2.5f;
+    }
+    NGOLOG(logDEBUG) << NgoLogArray(values,n,", ");
+    CHECK_EQUAL(reference.str(), std::string(logger->getBufferedMessage()));
+
+    // printf text, and the arrays larger than the buffer of the manipulator
+    char printed[64];
+    snprintf(printed,sizeof(printed),"INFO\t: %.5e\n",values[5]);
+    NGOLOG(logINFO) << values[5];
+    CHECK_EQUAL(std::string(printed), std::string(logger->getBufferedMessage()));
+    std::vector<double> many(500,-1.234567e-100);
+    std::ostringstream loop;
+    loop.setf(std::ios::scientific,std::ios::floatfield);
+    loop.precision(5);
+    for (size_t i=0;i<many.size();i++)
+        loop << (i ? " " : "") << many[i];
+    std::ostringstream array;
+    array.setf(std::ios::scientific,std::ios::floatfield);
+    array.precision(5);
+    array << NgoLogArray(many);
+    CHECK_EQUAL(loop.str(), array.str());
+    std::ostringstream general;
+    general << NgoLogArray(many.data(),2,"|");
+    CHECK_EQUAL(std::string("-1.23457e-100|-1.23457e-100"), general.str());
+    NgoLoggerManager::kill();
+}
+
+TEST(LogfLongMessage)
+{
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    std::string longText(3000,'x');
+    CHECK_EQUAL(1, NgoLogf(logWARNING,"%s|%d",longText.c_str(),42));
+    CHECK_EQUAL("WARNING\t: " + longText + "|42\n", std::string(logger->getBufferedMessage()));
+    NgoLogf(logINFO,"short %d",1);
+    CHECK_EQUAL(std::string("INFO\t: short 1\n"), std::string(logger->getBufferedMessage()));
+    NgoLoggerManager::kill();
+}
+
+TEST(LogWriteBatch)
+{
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logINFO);
+    NgoLogEntry entries[] = {
+        {logERROR, "first", -1},
+        {logDEBUG, "filtered", -1},
+        {logINFO, "second, truncated", 6},
+        {logWARNING, 0L, -1}
+    };
+    CHECK_EQUAL(2, NgoLogWriteBatch(entries,4));
+    CHECK_EQUAL(std::string("ERROR\t: first\nINFO\t: second\n"), std::string(logger->getBufferedMessage()));
+    CHECK_EQUAL(0, NgoLogWriteBatch(entries,0));
+
+    // levels from C or Fortran callers are checked before indexing the level names
+    NgoLogEntry invalid[] = {
+        {logERROR, "not written", -1},
+        {(TLogLevel)-1, "negative", -1},
+        {(TLogLevel)(logDEBUG4+1), "too verbose", -1}
+    };
+    CHECK_EQUAL(-1, NgoLogWriteBatch(invalid,3));
+    CHECK_EQUAL(-1, NgoLogWriteBatch(invalid+2,1));
+    CHECK_EQUAL(-1, NgoLogf((TLogLevel)-3,"negative %d",1));
+    CHECK_EQUAL(-1, NgoLogf((TLogLevel)42,"too verbose"));
+    CHECK(logger->isBufferEmpty());
+    NgoLoggerManager::kill();
+}
+
 TEST(LogIntoFile)
 {
     new NgoLoggerFilename("C:\\test.log", "w+",logDEBUG2);
@@ -114,6 +499,1080 @@ TEST(LogIntoFile)
     NgoLoggerManager::kill();
 }
 
+TEST(LogCategoryCeiling)
+{
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    evaluations = 0;
+    NGOLOG_CAT(NgoLogTestKernel, logDEBUG) << "compiled out " << countEvaluation();
+    NGOLOG_CAT(NgoLogTestKernel, logINFO) << "compiled out " << countEvaluation();
+    CHECK_EQUAL(0, evaluations);
+    CHECK(logger->isBufferEmpty());
+    NGOLOG_CAT(NgoLogTestKernel, logWARNING) << "compiled in " << countEvaluation();
+    CHECK_EQUAL(1, evaluations);
+    CHECK_EQUAL(std::string("WARNING\t: compiled in 1\n"), std::string(logger->getBufferedMessage()));
+    NgoLoggerManager::kill();
+}
+
+TEST(LogConfigureLevels)
+{
+    NgoLoggerBufferedString * solver = new NgoLoggerBufferedString(logINFO);
+    solver->setName("solver");
+    NgoLoggerBufferedString * other = new NgoLoggerBufferedString(logINFO);
+    NgoLoggerManager::get()->getBufferedLogger()->setReportingLevel(logERROR);
+
+    NgoLogConfig::configure("*=ERROR # quiet by default\nsolver = debug2; NgoLogTestKernel=ERROR");
+    CHECK_EQUAL(logDEBUG2, solver->reportingLevel());
+    CHECK_EQUAL(logERROR, other->reportingLevel());
+    CHECK(NgoLoggerManager::isEnabled(logDEBUG2));
+    CHECK(!NgoLoggerManager::isEnabled(logDEBUG3));
+    evaluations = 0;
+    NGOLOG_CAT(NgoLogTestKernel, logWARNING) << "disabled at runtime " << countEvaluation();
+    CHECK_EQUAL(0, evaluations);
+
+    // a configuration which does not parse changes nothing
+    CHECK_THROW(NgoLogConfig::configure("*=ERROR;solver=VERBOSE"), NgoErrorInvalidArgument);
+    CHECK_EQUAL(logDEBUG2, solver->reportingLevel());
+
+    // the levels not configured any more are the ones set by the code
+    NgoLogConfig::configure("*=ERROR");
+    CHECK_EQUAL(logERROR, solver->reportingLevel());
+    CHECK(!NgoLoggerManager::isEnabled(logWARNING));
+    NgoLogConfig::configure("");
+    CHECK_EQUAL(logINFO, solver->reportingLevel());
+    CHECK_EQUAL(logINFO, other->reportingLevel());
+    NGOLOG_CAT(NgoLogTestKernel, logWARNING) << "enabled again " << countEvaluation();
+    CHECK_EQUAL(1, evaluations);
+    NgoLoggerManager::kill();
+
+#ifndef _WIN32
+    // the environment is applied when the manager starts
+    setenv(NGOLOG_LEVELS_ENV,"*=WARNING",1);
+    NgoLoggerManager::init();
+    CHECK_EQUAL(logWARNING, NgoLoggerManager::get()->getBufferedLogger()->reportingLevel());
+    CHECK(!NgoLoggerManager::isEnabled(logINFO));
+    unsetenv(NGOLOG_LEVELS_ENV);
+    NgoLoggerManager::kill();
+#endif
+}
+
+#ifdef __linux__
+TEST(LogConfigureWatch)
+{
+    const char * filename = "test_levels.conf";
+    std::ofstream(filename) << "solver=DEBUG\n";
+    NgoLoggerBufferedString * solver = new NgoLoggerBufferedString(logERROR);
+    solver->setName("solver");
+    NgoLogConfig::watch(filename);
+    CHECK_EQUAL(logDEBUG, solver->reportingLevel());
+
+    // replaced as an editor does
+    std::ofstream("test_levels.conf.tmp") << "solver=WARNING\n";
+    rename("test_levels.conf.tmp",filename);
+    for (int i=0;i<200 && solver->reportingLevel() != logWARNING;i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK_EQUAL(logWARNING, solver->reportingLevel());
+    NgoLoggerManager::kill();
+    remove(filename);
+}
+#endif
+
+#ifndef _WIN32
+std::string readAll(int fd)
+{
+    std::string ret;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd,buffer,sizeof(buffer))) > 0)
+        ret.append(buffer,n);
+    return ret;
+}
+
+/*! @brief runs f with stderr redirected, and returns what was written to it */
+template <class F>
+std::string captureStderr(F f)
+{
+    fflush(stderr);
+    int fds[2];
+    if (pipe(fds) != 0)
+        return "";
+    int saved = dup(2);
+    dup2(fds[1],2);
+    f();
+    fflush(stderr);
+    dup2(saved,2);
+    close(saved);
+    close(fds[1]);
+    std::string ret = readAll(fds[0]);
+    close(fds[0]);
+    return ret;
+}
+
+TEST(LoggerManagerLifecycle)
+{
+    NgoLoggerManager::kill();
+    CHECK_EQUAL((int)NgoLoggerManager::UNINITIALISED, (int)NgoLoggerManager::phase());
+    NgoLoggerManager::init();
+    CHECK_EQUAL((int)NgoLoggerManager::RUNNING, (int)NgoLoggerManager::phase());
+    CHECK(NgoLoggerManager::get()->getBufferedLogger() != 0L);
+
+    // without logger, a log goes to stderr and does not create one
+    delete NgoLoggerManager::get()->getBufferedLogger();
+    CHECK(NgoLoggerManager::get()->getBufferedLogger() == 0L);
+    std::string err = captureStderr([]() { NGOLOG(logERROR) << "no logger"; });
+    CHECK_EQUAL(std::string("ERROR\t: no logger\n"), err);
+    CHECK(NgoLoggerManager::get()->getLoggers().empty());
+
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    NGOLOG(logINFO) << "before shutdown";
+    CHECK_EQUAL(std::string("INFO\t: before shutdown\n"), std::string(logger->getBufferedMessage()));
+
+    // late logs: warnings and errors to stderr, the rest dropped, no registration
+    NgoLoggerManager::shutdown();
+    CHECK_EQUAL((int)NgoLoggerManager::SHUT_DOWN, (int)NgoLoggerManager::phase());
+    CHECK(!NgoLoggerManager::isEnabled(logINFO));
+    err = captureStderr([]() {
+        NGOLOG(logWARNING) << "late warning";
+        NGOLOG(logINFO) << "late info";
+        NgoLog(logDEBUG).get() << "late debug";
+    });
+    CHECK_EQUAL(std::string("WARNING\t: late warning\n"), err);
+    NgoLoggerBufferedString late(logDEBUG4);
+    CHECK(NgoLoggerManager::get()->getLoggers().empty());
+    CHECK_EQUAL((int)NgoLoggerManager::SHUT_DOWN, (int)NgoLoggerManager::phase());
+
+    NgoLoggerManager::init();
+    CHECK_EQUAL((int)NgoLoggerManager::RUNNING, (int)NgoLoggerManager::phase());
+    CHECK_EQUAL(1, (int)NgoLoggerManager::get()->getLoggers().size());
+    NgoLoggerManager::kill();
+    CHECK_EQUAL((int)NgoLoggerManager::UNINITIALISED, (int)NgoLoggerManager::phase());
+    late.setReportingLevel(logDEBUG);
+    CHECK_EQUAL((int)NgoLoggerManager::UNINITIALISED, (int)NgoLoggerManager::phase());
+}
+
+TEST(CrashHandlerEmergencyFlush)
+{
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    new NgoLoggerBufferedString(logDEBUG4);
+    NgoCrashHandler::install(fds[1],32);
+    NGOLOG(logINFO) << "first record which is overwritten";
+    NGOLOG(logINFO) << "last record";
+    NgoCrashHandler::emergencyFlush();
+    NgoCrashHandler::uninstall();
+    close(fds[1]);
+    std::string flushed = readAll(fds[0]);
+    close(fds[0]);
+    CHECK_EQUAL(std::string(" overwritten\nINFO\t: last record\n"), flushed);
+    NgoLoggerManager::kill();
+
+    // the logs still in the thread buffers are in the ring, once
+    CHECK(pipe(fds) == 0);
+    new NgoLoggerBufferedString(logDEBUG4);
+    NgoLoggerManager::get()->enableThreadBuffers();
+    NgoCrashHandler::install(fds[1],64);
+    NGOLOG(logINFO) << "buffered record";
+    NgoCrashHandler::emergencyFlush();
+    NgoLoggerManager::get()->disableThreadBuffers();
+    NgoCrashHandler::emergencyFlush();
+    NgoCrashHandler::uninstall();
+    close(fds[1]);
+    flushed = readAll(fds[0]);
+    close(fds[0]);
+    CHECK_EQUAL(std::string("INFO\t: buffered record\nINFO\t: buffered record\n"), flushed);
+    NgoLoggerManager::kill();
+}
+
+TEST(CrashHandlerInstallWhileLogging)
+{
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    new NgoLoggerBufferedString(logDEBUG4);
+    NgoLoggerManager::get()->enableThreadBuffers();
+    std::atomic<bool> done(false);
+    std::vector<std::thread> pool;
+    for (int t=0;t<4;t++)
+        pool.push_back(std::thread([&done]() {
+            while (!done.load())
+                NGOLOG(logINFO) << "record logged while the ring changes";
+        }));
+    for (int i=0;i<200;i++)
+    {
+        NgoCrashHandler::install(fds[1],64+i);
+        NgoCrashHandler::uninstall();
+    }
+    done.store(true);
+    for (size_t t=0;t<pool.size();t++)
+        pool[t].join();
+    CHECK(!NgoCrashHandler::isInstalled());
+    NgoLoggerManager::kill();
+    close(fds[1]);
+    close(fds[0]);
+}
+
+TEST(CrashHandlerReraisesSignal)
+{
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        new NgoLoggerBufferedString(logDEBUG4);
+        NgoCrashHandler::install(fds[1]);
+        NGOLOG(logERROR) << "record lost in the buffered logger";
+        abort();
+    }
+    close(fds[1]);
+    std::string flushed = readAll(fds[0]);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid,&status,0);
+    CHECK(WIFSIGNALED(status));
+    CHECK_EQUAL(SIGABRT, WTERMSIG(status));
+    CHECK(flushed.find("ERROR\t: record lost in the buffered logger\n") != std::string::npos);
+}
+
+TEST(LogSharedMemoryRing)
+{
+    NgoLoggerSharedMemory * logger = new NgoLoggerSharedMemory("/ngoerr_test_ring",4,64,logDEBUG4,true);
+    NgoLogSharedMemoryReader reader("/ngoerr_test_ring");
+    NgoLogSharedMemoryReader::Record record;
+    CHECK(!reader.next(record));
+
+    NGOLOG(logINFO) << "record 0";
+    CHECK(reader.next(record));
+    CHECK_EQUAL(0ULL, record.sequence);
+    CHECK_EQUAL(0ULL, record.lost);
+    CHECK_EQUAL(logINFO, record.level);
+    CHECK_EQUAL(std::string("INFO\t: record 0\n"), record.text);
+
+    // 6 records in a ring of 4 slots: the 2 oldest are lost for the reader
+    for (int i=1;i<=6;i++)
+        NGOLOG(logWARNING) << "record " << i;
+    CHECK(reader.next(record));
+    CHECK_EQUAL(3ULL, record.sequence);
+    CHECK_EQUAL(2ULL, record.lost);
+    CHECK_EQUAL(std::string("WARNING\t: record 3\n"), record.text);
+    int count = 1;
+    while (reader.next(record))
+        count++;
+    CHECK_EQUAL(4, count);
+
+    NGOLOG(logINFO) << "a record much longer than the 48 bytes which are available in a slot";
+    CHECK(reader.next(record));
+    CHECK(record.truncated);
+    CHECK_EQUAL(size_t(48), record.text.size());
+    delete logger;
+
+    // a ring kept, then created again larger, is mapped again by the reader attached
+    logger = new NgoLoggerSharedMemory("/ngoerr_test_ring_kept",4,64,logDEBUG4,false);
+    NgoLogSharedMemoryReader kept("/ngoerr_test_ring_kept");
+    for (int i=0;i<6;i++)
+        NGOLOG(logINFO) << "old ring " << i;
+    CHECK(kept.next(record));
+    delete logger;
+    logger = new NgoLoggerSharedMemory("/ngoerr_test_ring_kept",64,128,logDEBUG4,true);
+    CHECK(!kept.next(record));
+    for (int i=0;i<40;i++)
+        NGOLOG(logINFO) << "new ring " << i;
+    CHECK(kept.next(record));
+    CHECK_EQUAL(0ULL, record.sequence);
+    CHECK_EQUAL(std::string("INFO\t: new ring 0\n"), record.text);
+    count = 1;
+    while (kept.next(record))
+        count++;
+    CHECK_EQUAL(40, count);
+    CHECK_EQUAL(std::string("INFO\t: new ring 39\n"), record.text);
+    delete logger;
+    NgoLoggerManager::kill();
+}
+#endif
+
+bool compressRoundTrip(const std::string & raw)
+{
+    std::vector<char> compressed(NgoLogCompressBound(raw.size()));
+    size_t n = NgoLogCompress(raw.data(),raw.size(),compressed.data(),compressed.size());
+    if (n == 0 || n > compressed.size())
+        return false;
+    std::string back(raw.size(),'\0');
+    return NgoLogDecompress(compressed.data(),n,&back[0],back.size()) && back == raw;
+}
+
+TEST(LogCompressCodec)
+{
+    CHECK(compressRoundTrip(""));
+    CHECK(compressRoundTrip("short"));
+    CHECK(compressRoundTrip(std::string(100000,'a')));
+    std::string random(70000,'\0');
+    unsigned seed = 12345;
+    for (size_t i=0;i<random.size();i++)
+    {
+        seed = seed*1103515245u+12345u;
+        random[i] = (char)(seed >> 16);
+    }
+    CHECK(compressRoundTrip(random));
+    std::string records;
+    for (int i=0;i<2000;i++)
+        records += "INFO\t: iteration " + std::to_string(i) + " converged\n";
+    CHECK(compressRoundTrip(records));
+
+    std::vector<char> compressed(NgoLogCompressBound(records.size()));
+    size_t n = NgoLogCompress(records.data(),records.size(),compressed.data(),compressed.size());
+    CHECK(n < records.size()/4);
+    CHECK_EQUAL(size_t(0), NgoLogCompress(records.data(),records.size(),compressed.data(),records.size()/2));
+    // a corrupted or truncated block is detected
+    std::string back(records.size(),'\0');
+    CHECK(!NgoLogDecompress(compressed.data(),n-1,&back[0],back.size()));
+    CHECK(!NgoLogDecompress(compressed.data(),n,&back[0],back.size()-1));
+}
+
+TEST(LogIntoCompressedFile)
+{
+    const char * filename = "test_compressed.ngz";
+    NgoLoggerCompressed * logger = new NgoLoggerCompressed(filename,4096);
+    std::string expected;
+    for (int i=0;i<1000;i++)
+    {
+        NGOLOG(logINFO) << "record " << i;
+        expected += "INFO\t: record " + std::to_string(i) + "\n";
+    }
+    NgoLoggerManager::get()->flush();
+    delete logger;
+    NgoLoggerManager::kill();
+
+    NgoLogCompressedReader reader(filename);
+    std::string text, all;
+    int blocks = 0;
+    while (reader.next(text))
+    {
+        CHECK(text.size() <= 4096);
+        CHECK_EQUAL('\n', text[text.size()-1]);
+        all += text;
+        blocks++;
+    }
+    CHECK_EQUAL(expected, all);
+    CHECK(blocks > 1);
+    CHECK(reader.storedBytes() < expected.size()/2);
+
+    // appending keeps a single file header
+    logger = new NgoLoggerCompressed(filename,4096,logDEBUG4,true);
+    NGOLOG(logINFO) << "appended";
+    delete logger;
+    NgoLoggerManager::kill();
+    NgoLogCompressedReader appended(filename);
+    all.clear();
+    while (appended.next(text))
+        all += text;
+    CHECK_EQUAL(expected+"INFO\t: appended\n", all);
+    remove(filename);
+
+    // corrupted sizes raise an error without allocating them
+    const unsigned char huge[2][8] = {{16,0,0,0xff, 16,0,0,0}, {0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff}};
+    for (int i=0;i<2;i++)
+    {
+        FILE * file = fopen(filename,"wb");
+        fwrite(NGOLOG_COMPRESSED_MAGIC,1,8,file);
+        fwrite(NGOLOG_BLOCK_MAGIC,1,4,file);
+        fwrite(huge[i],1,8,file);
+        fwrite("checksum and some data",1,22,file);
+        fclose(file);
+        NgoLogCompressedReader corrupted(filename);
+        CHECK_THROW(corrupted.next(text), NgoError);
+        remove(filename);
+    }
+}
+
+TEST(LogIndexQuery)
+{
+    const char * filename = "test_indexed.log";
+    new NgoLoggerFilename(filename,"w+",logDEBUG4,true);
+    // large enough for the scan without index to be cut in two parts
+    const int n = 30000;
+    for (int i=0;i<n;i++)
+        NGOLOG(i%100 == 0 ? logWARNING : logINFO) << "record " << i << " padded to make a log file of a few megabytes, scanned in parts";
+    try
+    {
+        throw NgoErrorInvalidArgument(1,"indexed error","test");
+    }
+    catch (NgoError & er)
+    {
+        NgoLogError(er);
+    }
+    NGOLOG(logINFO) << "last record";
+    NgoLoggerManager::kill();
+
+    NgoLogIndex index(filename);
+    CHECK_EQUAL(size_t(n+2), index.size());
+    NgoLogRecordReader reader(filename);
+    CHECK_EQUAL(std::string("INFO\t: record 1 padded to make a log file of a few megabytes, scanned in parts\n"), reader.read(index[1]));
+
+    NgoLogQuery byCode;
+    byCode.code = E_INVALIDARGUMENT;
+    std::vector<size_t> selected = index.select(byCode);
+    CHECK_EQUAL(size_t(1), selected.size());
+    CHECK_EQUAL(size_t(n), selected[0]);
+    const std::string error = reader.read(index[n]);
+    CHECK(error.find("indexed error") != std::string::npos);
+    CHECK_EQUAL('-', error[error.size()-2]);
+
+    NgoLogQuery warnings;
+    warnings.level = logWARNING;
+    selected = index.select(warnings,4);
+    CHECK_EQUAL(size_t(n/100+1), selected.size());
+    NgoLogQuery before;
+    before.to = index[0].time;
+    CHECK(index.select(before).empty());
+
+    // the scan finds the same records, the multi line error included
+    std::vector<NgoLogIndexEntry> scanned = NgoLogScan(filename,warnings,4);
+    CHECK_EQUAL(selected.size(), scanned.size());
+    for (size_t i=0;i<selected.size() && i<scanned.size();i++)
+    {
+        CHECK_EQUAL(index[selected[i]].offset, scanned[i].offset);
+        CHECK_EQUAL(index[selected[i]].length, scanned[i].length);
+    }
+    CHECK_THROW(NgoLogScan(filename,byCode), NgoError);
+    remove(filename);
+    remove((std::string(filename)+NGOLOG_INDEX_SUFFIX).c_str());
+}
+
+TEST(LogIndexCompressed)
+{
+    const char * filename = "test_indexed.ngz";
+    new NgoLoggerCompressed(filename,1024,logDEBUG4,false,true);
+    for (int i=0;i<500;i++)
+        NGOLOG(i%50 == 0 ? logWARNING : logINFO) << "record " << i;
+    NgoLoggerManager::kill();
+
+    NgoLogIndex index(filename);
+    CHECK_EQUAL(size_t(500), index.size());
+    NgoLogQuery warnings;
+    warnings.level = logWARNING;
+    std::vector<size_t> selected = index.select(warnings);
+    std::vector<NgoLogIndexEntry> scanned = NgoLogScan(filename,warnings,2);
+    CHECK_EQUAL(size_t(10), selected.size());
+    CHECK_EQUAL(size_t(10), scanned.size());
+    NgoLogRecordReader reader(filename);
+    for (size_t i=0;i<selected.size() && i<scanned.size();i++)
+    {
+        const NgoLogIndexEntry & entry = index[selected[i]];
+        CHECK_EQUAL("WARNING\t: record " + std::to_string(50*i) + "\n", reader.read(entry));
+        CHECK_EQUAL(entry.block, scanned[i].block);
+        CHECK_EQUAL(entry.offset, scanned[i].offset);
+    }
+    CHECK(index[499].block > index[0].block);
+    remove(filename);
+    remove((std::string(filename)+NGOLOG_INDEX_SUFFIX).c_str());
+}
+
+TEST(ScopeTimerPercentiles)
+{
+    NgoTimer timer("test.timer");
+    for (uint64_t i=1;i<=1000;i++)
+        timer.record(i);
+    NgoTimerSummary summary = timer.summary();
+    CHECK_EQUAL(1000ULL, (unsigned long long)summary.count);
+    CHECK_CLOSE(500.5, summary.mean, 1e-9);
+    // upper bounds of the buckets, within 1/32
+    CHECK(summary.p50 >= 500 && summary.p50 <= 500+500/32);
+    CHECK(summary.p99 >= 990 && summary.p99 <= 990+990/32);
+    CHECK(summary.p999 >= 999 && summary.p999 <= 1000);
+    CHECK_EQUAL(1000ULL, (unsigned long long)summary.max);
+
+    // the histograms of the threads are merged
+    std::vector<std::thread> pool;
+    for (int t=0;t<4;t++)
+        pool.push_back(std::thread([&timer]() {
+            for (int i=0;i<1000;i++)
+                timer.record(2000000);
+        }));
+    for (int t=0;t<4;t++)
+        pool[t].join();
+    summary = timer.summary();
+    CHECK_EQUAL(5000ULL, (unsigned long long)summary.count);
+    CHECK_EQUAL(2000000ULL, (unsigned long long)summary.max);
+    CHECK(summary.p50 >= 2000000 && summary.p50 <= 2000000+2000000/32);
+
+    // reported in the logs, then reset
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    NgoTimer::report(logINFO,true);
+    const std::string report = logger->getBufferedMessage();
+    CHECK(report.find("INFO\t: timer test.timer : n=5000 p50=2") != std::string::npos);
+    CHECK(report.find(" max=2ms\n") != std::string::npos);
+    CHECK_EQUAL(0ULL, (unsigned long long)timer.summary().count);
+
+    // a named timer is found again, and times its scope
+    CHECK(&NgoTimer::get("test.scope") == &NgoTimer::get("test.scope"));
+    for (int i=0;i<3;i++)
+    {
+        NGO_SCOPE_TIMER("test.scope");
+    }
+    CHECK_EQUAL(3ULL, (unsigned long long)NgoTimer::get("test.scope").summary().count);
+
+    // periodic reports
+    NgoTimer::reportEvery(0.01);
+    for (int i=0;i<200 && logger->isBufferEmpty();i++)
+    {
+        NgoTimer::get("test.scope").record(1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    NgoTimer::stopReporting();
+    CHECK(std::string(logger->getBufferedMessage()).find("timer test.scope : n=") != std::string::npos);
+    NgoLoggerManager::kill();
+}
+
+static size_t countOf(const std::string & text, const std::string & pattern)
+{
+    size_t n = 0;
+    for (size_t pos=text.find(pattern);pos!=std::string::npos;pos=text.find(pattern,pos+1))
+        n++;
+    return n;
+}
+
+static std::string scopeInSpans(int depth)
+{
+    NGO_TRACE_SPAN("deep");
+    if (depth > 1)
+        return scopeInSpans(depth-1);
+    NGO_TRACE_SPAN("inner");
+    return NgoError().getScope();
+}
+
+TEST(TraceSpans)
+{
+    // an error takes the spans it is built in as the outer part of its scope
+    {
+        NGO_TRACE_SPAN("solve");
+        NGO_TRACE_SPAN("flash");
+        NgoError er("no convergence","kernel");
+        CHECK_EQUAL(std::string("solve->flash->kernel"), er.getScope());
+        CHECK(std::string(er.what()).find("Scope : solve->flash->kernel") != std::string::npos);
+        er.addScopeError("caller");
+        CHECK_EQUAL(std::string("solve->flash->caller->kernel"), er.getScope());
+    }
+    CHECK_EQUAL(std::string("kernel"), NgoError("","kernel").getScope());
+    // only the innermost spans are kept
+    const std::string scope = scopeInSpans(NGO_ERR_MAX_SPANS+2);
+    CHECK(scope.compare(0,9,"...->deep") == 0);
+    CHECK(scope.size() > 5 && scope.compare(scope.size()-5,5,"inner") == 0);
+    CHECK_EQUAL((size_t)NGO_ERR_MAX_SPANS, countOf(scope,"->"));
+    CHECK_EQUAL(std::string(""), NgoError().getScope());
+
+    // spans are recorded between start and stop, from every thread
+    CHECK(!NgoTrace::recording());
+    {
+        NGO_TRACE_SPAN("before");
+    }
+    NgoTrace::start();
+    CHECK(NgoTrace::recording());
+    {
+        NGO_TRACE_SPAN("main \"quoted\"");
+        std::thread worker([]() {
+            for (int i=0;i<3;i++)
+            {
+                NGO_TRACE_SPAN("worker");
+            }
+        });
+        worker.join();
+    }
+    NgoTrace::stop();
+    {
+        NGO_TRACE_SPAN("after");
+    }
+    std::string json = NgoTrace::chromeJson();
+    CHECK(json.compare(0,16,"{\"traceEvents\":[") == 0);
+    CHECK_EQUAL((size_t)4, countOf(json,"\"ph\":\"B\""));
+    CHECK_EQUAL((size_t)4, countOf(json,"\"ph\":\"E\""));
+    CHECK_EQUAL((size_t)2, countOf(json,"\"thread_name\""));
+    CHECK(json.find("\"name\":\"main \\\"quoted\\\"\"") != std::string::npos);
+    CHECK_EQUAL(std::string::npos, json.find("before"));
+    CHECK_EQUAL(std::string::npos, json.find("after"));
+
+    // beyond the capacity, spans are dropped, and a new session forgets the previous one
+    NgoTrace::start(4);
+    for (int i=0;i<5;i++)
+    {
+        NGO_TRACE_SPAN("capped");
+    }
+    NgoTrace::stop();
+    json = NgoTrace::chromeJson();
+    CHECK_EQUAL((size_t)2, countOf(json,"\"ph\":\"B\""));
+    CHECK_EQUAL((size_t)2, countOf(json,"\"ph\":\"E\""));
+    CHECK_EQUAL((size_t)3, NgoTrace::dropped());
+    CHECK_EQUAL(std::string::npos, json.find("worker"));
+
+    NgoTrace::write("trace_test.json");
+    std::ifstream file("trace_test.json");
+    std::string written((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+    CHECK_EQUAL(json, written);
+    remove("trace_test.json");
+}
+
+TEST(ErrorCollectorFromThreads)
+{
+    NgoErrorCollector collector;
+    CHECK(collector.empty());
+    std::vector<std::thread> workers;
+    for (int t=0;t<4;t++)
+        workers.push_back(std::thread([t,&collector]() {
+            for (int i=0;i<100;i++)
+            {
+                try
+                {
+                    if (i == 50 && t == 2)
+                        throw NgoErrorInvalidArgument(3,"bad composition","flash");
+                    throw NgoErrorSolving("no convergence","flash");
+                }
+                catch (...)
+                {
+                    collector.addCurrent();
+                }
+            }
+        }));
+    for (size_t t=0;t<workers.size();t++)
+        workers[t].join();
+
+    CHECK_EQUAL(size_t(400), collector.size());
+    std::vector<NgoErrorCollector::Group> groups = collector.groups();
+    CHECK_EQUAL(size_t(2), groups.size());
+    CHECK_EQUAL(int(E_INVALIDARGUMENT), groups[0].code);
+    CHECK_EQUAL(1u, groups[0].count);
+    CHECK_EQUAL(int(E_SOLVINGERROR), groups[1].code);
+    CHECK_EQUAL(399u, groups[1].count);
+    CHECK_EQUAL(std::string("flash"), groups[1].scope);
+
+    CHECK_THROW(collector.rethrow(NgoErrorCollector::MOST_SEVERE), NgoErrorInvalidArgument);
+    CHECK(collector.empty());
+    collector.rethrow();
+}
+
+TEST(ErrorCollectorComposite)
+{
+    NgoErrorCollector collector;
+    try { throw NgoErrorSolving("no convergence","flash"); }
+    catch (NgoError & er) { collector.add(er); }
+    collector.add(NgoErrorNoImpl("not implemented","model"));
+    try
+    {
+        collector.rethrow(NgoErrorCollector::COMPOSITE);
+        CHECK(false);
+    }
+    catch (NgoErrorComposite & er)
+    {
+        CHECK_EQUAL(int(E_NOIMPL), er.getCode());
+        CHECK_EQUAL(size_t(2), er.errors().size());
+        CHECK(er.getDescription().find("1 x Solving Error in flash : no convergence") != std::string::npos);
+        CHECK_THROW(std::rethrow_exception(er.errors()[1]), NgoErrorSolving);
+    }
+
+    // other exceptions are described as unknown errors, and rethrown as they are
+    try { throw std::runtime_error("bad allocation of a stream"); }
+    catch (...) { collector.addCurrent(); }
+    collector.addCurrent();
+    collector.add(std::exception_ptr());
+    CHECK_EQUAL(size_t(1), collector.size());
+    std::vector<NgoErrorCollector::Group> groups = collector.groups();
+    CHECK_EQUAL(int(E_UNKNOWN), groups[0].code);
+    CHECK_EQUAL(std::string("bad allocation of a stream"), groups[0].first->getDescription());
+    CHECK_THROW(collector.rethrow(), std::runtime_error);
+}
+
+TEST(CheckBoundsMatchesScalarLoop)
+{
+    std::vector<double> values(203), lower(203), upper(203);
+    for (size_t i=0;i<values.size();i++)
+    {
+        values[i] = 300. + (i%7);
+        lower[i] = 250.;
+        upper[i] = 350.;
+    }
+    CHECK_EQUAL(NGO_NPOS, NgoFindFirstOutOfBounds(&values[0],values.size(),250.,350.));
+    CHECK_EQUAL(NGO_NPOS, NgoFindFirstOutOfBounds(&values[0],values.size(),&lower[0],&upper[0]));
+
+    // every length and offset of the blocks and of the tail
+    const size_t bad[] = {0, 1, 3, 4, 15, 16, 17, 100, 199, 202};
+    for (size_t b=0;b<sizeof(bad)/sizeof(bad[0]);b++)
+    {
+        for (size_t n=bad[b]+1;n<=values.size();n+=37)
+        {
+            std::vector<double> v(values.begin(),values.begin()+n);
+            v[bad[b]] = (b%2) ? 400. : UNDEFERR;
+            CHECK_EQUAL(bad[b], NgoFindFirstOutOfBounds(&v[0],n,250.,350.));
+            CHECK_EQUAL(bad[b], NgoFindFirstOutOfBounds(&v[0],n,&lower[0],&upper[0]));
+        }
+    }
+
+    values[5] = 100.;
+    values[16] = 500.;
+    values[202] = UNDEFERR;
+    upper[40] = 301.;
+    std::vector<size_t> indices;
+    CHECK_EQUAL(size_t(3), NgoFindOutOfBounds(&values[0],values.size(),250.,350.,indices));
+    CHECK_EQUAL(size_t(3), indices.size());
+    CHECK_EQUAL(size_t(5), indices[0]);
+    CHECK_EQUAL(size_t(16), indices[1]);
+    CHECK_EQUAL(size_t(202), indices[2]);
+    indices.clear();
+    CHECK_EQUAL(size_t(4), NgoFindOutOfBounds(&values[0],values.size(),&lower[0],&upper[0],indices));
+    CHECK_EQUAL(size_t(40), indices[2]);
+}
+
+TEST(CheckBoundsRaisesOutOfBounds)
+{
+    double temperatures[] = {300., 310., 1500., 320.};
+    NgoCheckBounds(temperatures,2,200.,1000.,"temperature",2,"flash");
+    try
+    {
+        NgoCheckBounds(temperatures,4,200.,1000.,"temperature",2,"flash");
+        CHECK(false);
+    }
+    catch (NgoErrorOutOfBounds & er)
+    {
+        CHECK_EQUAL(int(E_OUTOFBOUNDS), er.getCode());
+        CHECK_EQUAL(std::string("flash"), er.getScope());
+        CHECK_EQUAL(std::string("Element 2 of an array of 4 values is out of bounds"), er.getDescription());
+        std::ostringstream oss;
+        er.print(oss);
+        CHECK(oss.str().find("Argument with position 2") != std::string::npos);
+        CHECK(oss.str().find("of type temperature(= 1500) is out of bounds [200,1000]") != std::string::npos);
+    }
+}
+
+TEST(CheckFiniteKinds)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = -std::numeric_limits<double>::quiet_NaN();
+    CHECK_EQUAL(0, NgoNonFiniteKindOf(1e308));
+    CHECK_EQUAL(int(NGO_INF), NgoNonFiniteKindOf(-inf));
+    CHECK_EQUAL(int(NGO_UNDEFERR), NgoNonFiniteKindOf(UNDEFERR));
+    CHECK_EQUAL(int(NGO_NAN), NgoNonFiniteKindOf(nan));
+
+    std::vector<double> values(101,1.);
+    CHECK_EQUAL(NGO_NPOS, NgoFindFirstNonFinite(&values[0],values.size()));
+    values[17] = UNDEFERR;
+    values[40] = inf;
+    values[100] = nan;
+    CHECK_EQUAL(size_t(17), NgoFindFirstNonFinite(&values[0],values.size()));
+    CHECK_EQUAL(size_t(40), NgoFindFirstNonFinite(&values[0],values.size(),NGO_INF|NGO_NAN));
+    CHECK_EQUAL(size_t(100), NgoFindFirstNonFinite(&values[0],values.size(),NGO_NAN));
+    std::vector<size_t> indices;
+    CHECK_EQUAL(size_t(3), NgoFindNonFinite(&values[0],values.size(),indices));
+    CHECK_EQUAL(size_t(40), indices[1]);
+
+    NgoCheckFinite(&values[0],17);
+    try
+    {
+        NgoCheckFinite(&values[0],values.size(),NGO_INF|NGO_NAN,"enthalpy","flash");
+        CHECK(false);
+    }
+    catch (NgoErrorComputation & er)
+    {
+        CHECK_EQUAL(int(E_COMPUTATION), er.getCode());
+        CHECK_EQUAL(std::string("flash"), er.getScope());
+        CHECK_EQUAL(std::string("Element 40 of an array of 101 values of type enthalpy is +inf"), er.getDescription());
+    }
+}
+
+volatile double fpeZero = 0.;
+
+TEST(FpeGuardFlags)
+{
+    feclearexcept(FE_ALL_EXCEPT);
+    {
+        NgoFpeGuard guard("kernel");
+        volatile double x = 1. + fpeZero;
+        CHECK_EQUAL(0, guard.raised());
+        (void)x;
+    }
+    bool raisedOnExit = false;
+    try
+    {
+        NgoFpeGuard guard("kernel");
+        volatile double x = 1./fpeZero;
+        CHECK_EQUAL(int(FE_DIVBYZERO), guard.raised());
+        (void)x;
+    }
+    catch (NgoErrorComputation & er)
+    {
+        raisedOnExit = true;
+        CHECK_EQUAL(std::string("kernel"), er.getScope());
+        CHECK_EQUAL(std::string("Floating point exception: division by zero"), er.getDescription());
+    }
+    CHECK(raisedOnExit);
+    // flags raised in the region do not leak out of the guard
+    CHECK_EQUAL(0, fetestexcept(FE_DIVBYZERO));
+
+    NgoFpeGuard guard("kernel",FE_INVALID);
+    volatile double x = 1./fpeZero;
+    guard.check();
+    CHECK(x > 0.);
+    x = fpeZero/fpeZero;
+    CHECK(x != x);
+    CHECK_THROW(guard.check(), NgoErrorComputation);
+    CHECK_EQUAL(0, guard.raised());
+}
+
+TEST(FpeGuardNested)
+{
+    bool raisedOnExit = false;
+    try
+    {
+        NgoFpeGuard outer("outer",FE_OVERFLOW|FE_DIVBYZERO);
+        {
+            NgoFpeGuard inner("inner",FE_INVALID);
+            volatile double x = std::numeric_limits<double>::max()*(1.+fpeZero);
+            x = x*x;
+            CHECK_EQUAL(0, inner.raised());
+        }
+        // the overflow raised in the inner guard is left to the outer one
+        CHECK_EQUAL(int(FE_OVERFLOW), outer.raised());
+    }
+    catch (NgoErrorComputation & er)
+    {
+        raisedOnExit = true;
+        CHECK_EQUAL(std::string("outer"), er.getScope());
+        CHECK_EQUAL(std::string("Floating point exception: overflow"), er.getDescription());
+    }
+    CHECK(raisedOnExit);
+}
+
+TEST(FpeGuardTrap)
+{
+    try
+    {
+        NgoFpeGuard guard("kernel",FE_INVALID|FE_DIVBYZERO|FE_OVERFLOW,NgoFpeGuard::TRAP);
+        volatile double x = fpeZero/fpeZero;
+        // execution goes on after the trap
+        CHECK(x != x);
+        guard.check();
+        CHECK(false);
+    }
+    catch (NgoErrorComputation & er)
+    {
+        CHECK(er.getDescription().find("Floating point exception: invalid operation") == 0);
+#if defined(__GLIBC__) && defined(__x86_64__)
+        CHECK(er.getDescription().find("first trapped at instruction") != std::string::npos);
+#endif
+    }
+}
+
+std::string printed(const NgoError & er)
+{
+    std::ostringstream oss;
+    er.print(oss);
+    return oss.str();
+}
+
+TEST(ErrorPrintFormat)
+{
+    NgoErrorSolving solving("no convergence","flash","ICapeThermo","CalcEquilibrium");
+    CHECK_EQUAL(std::string("Error Solving :\n***************\nScope : flash\nInterface : ICapeThermo"
+                            "\nOperation : CalcEquilibrium\nDescription :\nno convergence"), printed(solving));
+
+    NgoErrorOutOfBounds bounds(1500.25,200.,1e5,"temperature",2,"too hot","flash");
+    CHECK_EQUAL(std::string("Out Of Bounds :\n***************\nScope : flash\nDescription :\ntoo hot"
+                            "\tArgument with position 2 is not correct.\n"
+                            "\tA value of type temperature(= 1500.25) is out of bounds [200,100000]\n"), printed(bounds));
+
+    NgoErrorOutOfBounds undefined;
+    CHECK_EQUAL(std::string("Out Of Bounds :\n***************\nDescription :\nAn argument value of the operation is out of bounds"
+                            "\tA value (= nan) is out of bounds [nan,nan]\n"), printed(undefined));
+
+    NgoErrorOutOfBounds small(1.5e-7,-1234567.,0.001);
+    CHECK(printed(small).find("(= 1.5e-07) is out of bounds [-1.23457e+06,0.001]") != std::string::npos);
+
+    // streamed into a log, the numbers follow its scientific notation, and what() is unchanged
+    NgoLoggerBufferedString * logger = new NgoLoggerBufferedString(logDEBUG4);
+    NgoErrorOutOfBounds logged(1234.5,0,1000,"T",1);
+    NGOLOG(logERROR) << logged;
+    CHECK(std::string(logger->getBufferedMessage()).find("(= 1.23450e+03) is out of bounds [0.00000e+00,1.00000e+03]\n") != std::string::npos);
+    CHECK(std::string(logged.what()).find("(= 1234.5) is out of bounds [0,1000]\n") != std::string::npos);
+    NgoLoggerManager::kill();
+}
+
+TEST(ErrorWhatIsCached)
+{
+    NgoErrorBadArgument er(3,"wrong unit","flash");
+    const char * text = er.what();
+    CHECK_EQUAL(printed(er), std::string(text));
+    CHECK(text == er.what());
+
+    er.addScopeError("process");
+    er.addDescription("expected K");
+    CHECK_EQUAL(std::string("Bad Argument :\n**************\nScope : process->flash\nDescription :\nwrong unit\nexpected K"
+                            "\tArgument with position 3 is not correct.\n"), std::string(er.what()));
+
+    NgoErrorBadArgument copy(er);
+    CHECK_EQUAL(std::string(er.what()), std::string(copy.what()));
+}
+
+TEST(ErrorCloneAndMove)
+{
+    NgoErrorOutOfBounds bounds(1500.25,200.,1e5,"temperature",2,"too hot","flash");
+    NgoError & er = bounds;
+    const std::string text = er.what();
+
+    // clone and rethrow keep the dynamic type through the base class
+    NgoError * clone = er.clone();
+    CHECK(dynamic_cast<NgoErrorOutOfBounds *>(clone) != 0L);
+    CHECK_EQUAL(text, std::string(clone->what()));
+    try
+    {
+        clone->rethrow();
+    }
+    catch (NgoErrorOutOfBounds & moved)
+    {
+        CHECK_EQUAL(text, std::string(moved.what()));
+    }
+    CHECK(clone->getDescription().empty());
+    delete clone;
+
+    // generic catch sites
+    try
+    {
+        NgoErrorSolving("no convergence","flash").rethrow();
+    }
+    catch (std::exception & e)
+    {
+        CHECK(std::string(e.what()).find("no convergence") != std::string::npos);
+    }
+
+    // sent to another thread in an exception_ptr
+    std::exception_ptr ptr = NgoErrorInvalidArgument(3,"wrong unit","flash").exceptionPtr();
+    bool caught = false;
+    std::thread([&ptr,&caught]() {
+        try
+        {
+            std::rethrow_exception(ptr);
+        }
+        catch (NgoErrorInvalidArgument & er)
+        {
+            caught = er.getDescription() == "wrong unit";
+        }
+    }).join();
+    CHECK(caught);
+
+    // the text is rendered before the error is shared: threads rethrowing it only read the cache
+    NgoErrorCollector shared;
+    try { throw NgoErrorSolving("no convergence","flash"); }
+    catch (...) { shared.addCurrent(); }
+    shared.add(NgoErrorNoImpl("not implemented","model").exceptionPtr());
+    std::vector<std::exception_ptr> errors;
+    try
+    {
+        shared.rethrow(NgoErrorCollector::COMPOSITE);
+    }
+    catch (NgoErrorComposite & er)
+    {
+        errors = er.errors();
+    }
+    CHECK_EQUAL(size_t(2), errors.size());
+    std::vector<std::thread> readers;
+    std::atomic<int> read(0);
+    for (int t=0;t<4;t++)
+        readers.push_back(std::thread([&errors,&read]() {
+            for (size_t i=0;i<errors.size();i++)
+            {
+                try
+                {
+                    std::rethrow_exception(errors[i]);
+                }
+                catch (std::exception & e)
+                {
+                    if (strstr(e.what(),"Description :\n"))
+                        read++;
+                }
+            }
+        }));
+    for (size_t t=0;t<readers.size();t++)
+        readers[t].join();
+    CHECK_EQUAL(8, read.load());
+
+    // an error collected outside its handler keeps its type
+    NgoErrorCollector collector;
+    collector.add(bounds);
+    CHECK_THROW(collector.rethrow(), NgoErrorOutOfBounds);
+
+    // an error collected in the handler of another exception, or a copy of it, is copied
+    NgoErrorCollector others;
+    try
+    {
+        throw std::runtime_error("unrelated");
+    }
+    catch (...)
+    {
+        NgoErrorInvalidArgument local(1,"bad flash specification");
+        others.add(local);
+    }
+    CHECK_THROW(others.rethrow(), NgoErrorInvalidArgument);
+    others.clear();
+    try
+    {
+        throw NgoErrorNoImpl("not yet");
+    }
+    catch (NgoErrorNoImpl & er)
+    {
+        NgoErrorNoImpl copy(er);
+        others.add(copy);
+    }
+    CHECK_EQUAL(std::string("not yet"), others.groups()[0].first->getDescription());
+    CHECK_THROW(others.rethrow(), NgoErrorNoImpl);
+}
+
+int cEntryPoint(int what)
+{
+    NGO_C_API_BEGIN
+        if (what == 1)
+            throw NgoErrorSolving("no convergence","flash");
+        if (what == 2)
+            throw std::runtime_error("not a NgoError");
+        if (what == 3)
+            throw 42;
+        if (what == 4)
+            throw NgoError("cannot open file");
+    NGO_C_API_END
+}
+
+TEST(LastErrorThroughCInterface)
+{
+    NgoClearLastError();
+    CHECK_EQUAL((int)E_OK, cEntryPoint(0));
+    CHECK_EQUAL((int)E_OK, NgoGetLastErrorCode());
+    CHECK_EQUAL(std::string(""), std::string(NgoGetLastErrorDescription()));
+
+    CHECK_EQUAL((int)E_SOLVINGERROR, cEntryPoint(1));
+    CHECK_EQUAL((int)E_SOLVINGERROR, NgoGetLastErrorCode());
+    CHECK_EQUAL(std::string("no convergence"), std::string(NgoGetLastErrorDescription()));
+    CHECK_EQUAL(std::string("flash"), std::string(NgoGetLastErrorScope()));
+    CHECK_EQUAL(printed(NgoErrorSolving("no convergence","flash")), std::string(NgoGetLastErrorText()));
+
+    // a success does not clear the last error, as errno
+    CHECK_EQUAL((int)E_OK, cEntryPoint(0));
+    CHECK_EQUAL((int)E_SOLVINGERROR, NgoGetLastErrorCode());
+
+    CHECK_EQUAL((int)E_UNKNOWN, cEntryPoint(2));
+    CHECK_EQUAL(std::string("not a NgoError"), std::string(NgoGetLastErrorDescription()));
+    CHECK_EQUAL(std::string(""), std::string(NgoGetLastErrorScope()));
+    CHECK_EQUAL((int)E_UNKNOWN, cEntryPoint(3));
+    // the library raises plain NgoError, whose code is E_UNKNOWN
+    NgoClearLastError();
+    CHECK_EQUAL((int)E_UNKNOWN, NgoError().getCode());
+    CHECK_EQUAL((int)E_UNKNOWN, cEntryPoint(4));
+    CHECK_EQUAL((int)E_UNKNOWN, NgoGetLastErrorCode());
+    CHECK_EQUAL(std::string("cannot open file"), std::string(NgoGetLastErrorDescription()));
+
+    int code = NgoCallNoThrow([]() { throw NgoErrorNoImpl(); });
+    CHECK_EQUAL((int)E_NOIMPL, code);
+
+    // the last error belongs to the thread
+    int otherCode = -1;
+    std::thread other([&otherCode]() { otherCode = NgoGetLastErrorCode(); });
+    other.join();
+    CHECK_EQUAL((int)E_OK, otherCode);
+    NgoClearLastError();
+    CHECK_EQUAL((int)E_OK, NgoGetLastErrorCode());
+}
+
 TEST(ExampleOfUse)
 {
     NgoLog log(logINFO);
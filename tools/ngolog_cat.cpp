@@ -0,0 +1,78 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file ngolog_cat.cpp
+@date October 2026
+@brief Tool to decompress the files written by NgoLoggerCompressed.
+
+Usage : ngolog_cat file... [--output=file] [--stats]
+
+The text of the files is written in order to the output. With --stats, the number of blocks and
+the compression ratio of each file are reported on stderr.
+ */
+
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoLoggerCompressed.h"
+
+int main(int argc, char ** argv)
+{
+    std::vector<const char *> files;
+    bool stats = false;
+    FILE * output = stdout;
+    for (int i=1;i<argc;i++)
+    {
+        if (strcmp(argv[i],"--stats") == 0)
+            stats = true;
+        else if (strncmp(argv[i],"--output=",9) == 0)
+        {
+            output = fopen(argv[i]+9,"wb");
+            if (!output)
+            {
+                fprintf(stderr,"ngolog_cat: impossible to open %s\n",argv[i]+9);
+                return 1;
+            }
+        }
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        fprintf(stderr,"usage: ngolog_cat file... [--output=file] [--stats]\n");
+        return 1;
+    }
+
+    int status = 0;
+    std::string text;
+    for (size_t i=0;i<files.size();i++)
+    {
+        try
+        {
+            NgoLogCompressedReader reader(files[i]);
+            unsigned long long blocks = 0;
+            unsigned long long rawBytes = 0;
+            while (reader.next(text))
+            {
+                fwrite(text.data(),1,text.size(),output);
+                blocks++;
+                rawBytes += text.size();
+            }
+            if (stats)
+                fprintf(stderr,"ngolog_cat: %s: %llu blocks, %llu bytes, %llu stored, ratio %.2f\n",
+                        files[i],blocks,rawBytes,reader.storedBytes(),
+                        reader.storedBytes() ? (double)rawBytes/reader.storedBytes() : 0.);
+        }
+        catch (NgoError & er)
+        {
+            fprintf(stderr,"ngolog_cat: %s\n",er.getDescription().c_str());
+            status = 1;
+        }
+    }
+    if (output != stdout)
+        fclose(output);
+    return status;
+}
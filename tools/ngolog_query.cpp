@@ -0,0 +1,103 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file ngolog_query.cpp
+@date October 2026
+@brief Tool to find the records of a log file by level, time range or error code.
+
+Usage : ngolog_query file [--level=LEVEL] [--from=SECONDS] [--to=SECONDS] [--code=CODE]
+                          [--threads=N] [--count] [--no-index]
+
+The file may be written by NgoLoggerFilename or NgoLoggerCompressed. When its index exists, the
+index is mapped and its entries are selected in parallel, then only the records selected are
+read. Otherwise the file is scanned in parallel, which only selects on the level. Times are in
+seconds since the epoch, and select the time at which the records reached the logger.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "ngoerr/NgoLogIndex.h"
+
+int main(int argc, char ** argv)
+{
+    const char * filename = 0L;
+    NgoLogQuery query;
+    unsigned threads = 0;
+    bool count = false;
+    bool useIndex = true;
+    for (int i=1;i<argc;i++)
+    {
+        if (strncmp(argv[i],"--level=",8) == 0)
+            query.level = NgoLoggerManager::fromString(argv[i]+8);
+        else if (strncmp(argv[i],"--from=",7) == 0)
+            query.from = (int64_t)(atof(argv[i]+7)*1e6);
+        else if (strncmp(argv[i],"--to=",5) == 0)
+            query.to = (int64_t)(atof(argv[i]+5)*1e6);
+        else if (strncmp(argv[i],"--code=",7) == 0)
+            query.code = atoi(argv[i]+7);
+        else if (strncmp(argv[i],"--threads=",10) == 0)
+            threads = (unsigned)atoi(argv[i]+10);
+        else if (strcmp(argv[i],"--count") == 0)
+            count = true;
+        else if (strcmp(argv[i],"--no-index") == 0)
+            useIndex = false;
+        else
+            filename = argv[i];
+    }
+    if (!filename)
+    {
+        fprintf(stderr,"usage: ngolog_query file [--level=LEVEL] [--from=SECONDS] [--to=SECONDS] [--code=CODE] "
+                       "[--threads=N] [--count] [--no-index]\n");
+        return 1;
+    }
+
+    try
+    {
+        NgoLogIndex * index = 0L;
+        if (useIndex)
+        {
+            try
+            {
+                index = new NgoLogIndex(filename);
+            }
+            catch (NgoError & er)
+            {
+                fprintf(stderr,"ngolog_query: %s, scanning the file\n",er.getDescription().c_str());
+            }
+        }
+        std::vector<NgoLogIndexEntry> entries;
+        if (index)
+        {
+            std::vector<size_t> selected = index->select(query,threads);
+            entries.reserve(selected.size());
+            for (size_t i=0;i<selected.size();i++)
+                entries.push_back((*index)[selected[i]]);
+            delete index;
+        }
+        else
+            entries = NgoLogScan(filename,query,threads);
+
+        if (count)
+        {
+            printf("%llu\n",(unsigned long long)entries.size());
+            return 0;
+        }
+        NgoLogRecordReader reader(filename);
+        for (size_t i=0;i<entries.size();i++)
+        {
+            const std::string & record = reader.read(entries[i]);
+            fwrite(record.data(),1,record.size(),stdout);
+        }
+    }
+    catch (NgoError & er)
+    {
+        fprintf(stderr,"ngolog_query: %s\n",er.getDescription().c_str());
+        return 1;
+    }
+    return 0;
+}
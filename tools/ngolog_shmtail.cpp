@@ -0,0 +1,95 @@
+/*******************************************************************************
+   FILE DESCRIPTION
+*******************************************************************************/
+/*!
+@file ngolog_shmtail.cpp
+@date October 2026
+@brief Tool to tail, filter or save the logs written by NgoLoggerSharedMemory in another process.
+
+Usage : ngolog_shmtail name [--level=LEVEL] [--follow] [--from-now] [--output=file]
+
+Records lost because the ring has been overwritten before being read are reported on stderr
+and as a line "*** N records lost ***" in the output.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <thread>
+
+#include "ngoerr/NgoLoggerSharedMemory.h"
+
+int main(int argc, char ** argv)
+{
+    const char * name = 0L;
+    TLogLevel level = logDEBUG4;
+    bool follow = false;
+    bool fromNow = false;
+    FILE * output = stdout;
+    for (int i=1;i<argc;i++)
+    {
+        if (strncmp(argv[i],"--level=",8) == 0)
+            level = NgoLoggerManager::fromString(argv[i]+8);
+        else if (strcmp(argv[i],"--follow") == 0)
+            follow = true;
+        else if (strcmp(argv[i],"--from-now") == 0)
+            fromNow = true;
+        else if (strncmp(argv[i],"--output=",9) == 0)
+        {
+            output = fopen(argv[i]+9,"a");
+            if (!output)
+            {
+                fprintf(stderr,"ngolog_shmtail: impossible to open %s\n",argv[i]+9);
+                return 1;
+            }
+        }
+        else
+            name = argv[i];
+    }
+    if (!name)
+    {
+        fprintf(stderr,"usage: ngolog_shmtail name [--level=LEVEL] [--follow] [--from-now] [--output=file]\n");
+        return 1;
+    }
+
+    try
+    {
+        NgoLogSharedMemoryReader reader(name,fromNow);
+        NgoLogSharedMemoryReader::Record record;
+        unsigned long long totalLost = 0;
+        for (;;)
+        {
+            if (!reader.next(record))
+            {
+                if (!follow)
+                    break;
+                fflush(output);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            if (record.lost)
+            {
+                totalLost += record.lost;
+                fprintf(output,"*** %llu records lost ***\n",record.lost);
+                fprintf(stderr,"ngolog_shmtail: %llu records lost before record %llu\n",record.lost,record.sequence);
+            }
+            if (record.level > level)
+                continue;
+            fwrite(record.text.data(),1,record.text.size(),output);
+            if (record.truncated)
+                fputs(" [truncated]\n",output);
+        }
+        if (totalLost)
+            fprintf(stderr,"ngolog_shmtail: %llu records lost in total\n",totalLost);
+    }
+    catch (NgoError & er)
+    {
+        fprintf(stderr,"ngolog_shmtail: %s\n",er.getDescription().c_str());
+        return 1;
+    }
+    if (output != stdout)
+        fclose(output);
+    return 0;
+}